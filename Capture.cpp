@@ -0,0 +1,105 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Capture.h"
+#include "Log.h"
+
+#include <cassert>
+
+CCapture::CCapture(const std::string& fileName) :
+m_fileName(fileName),
+m_fp(nullptr),
+m_stopWatch(),
+m_count(0U)
+{
+}
+
+CCapture::~CCapture()
+{
+}
+
+bool CCapture::open()
+{
+	m_fp = ::fopen(m_fileName.c_str(), "wb");
+	if (m_fp == nullptr) {
+		LogError("Cannot open the capture file - %s", m_fileName.c_str());
+		return false;
+	}
+
+	if (::fwrite(CAPTURE_MAGIC, 1U, CAPTURE_MAGIC_LENGTH, m_fp) != CAPTURE_MAGIC_LENGTH) {
+		LogError("Cannot write to the capture file - %s", m_fileName.c_str());
+		::fclose(m_fp);
+		m_fp = nullptr;
+		return false;
+	}
+
+	m_stopWatch.start();
+	m_count = 0U;
+
+	LogInfo("Capturing to %s", m_fileName.c_str());
+
+	return true;
+}
+
+bool CCapture::write(unsigned char topic, const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	if (m_fp == nullptr)
+		return false;
+
+	if (length > CAPTURE_MAX_LENGTH) {
+		LogWarning("Not capturing a message of %u bytes", length);
+		return false;
+	}
+
+	unsigned int time = m_stopWatch.elapsed();
+
+	unsigned char header[CAPTURE_HEADER_LENGTH];
+	header[0U] = (time >> 0) & 0xFFU;
+	header[1U] = (time >> 8) & 0xFFU;
+	header[2U] = (time >> 16) & 0xFFU;
+	header[3U] = (time >> 24) & 0xFFU;
+	header[4U] = topic;
+	header[5U] = (length >> 0) & 0xFFU;
+	header[6U] = (length >> 8) & 0xFFU;
+	header[7U] = (length >> 16) & 0xFFU;
+	header[8U] = (length >> 24) & 0xFFU;
+
+	if (::fwrite(header, 1U, CAPTURE_HEADER_LENGTH, m_fp) != CAPTURE_HEADER_LENGTH ||
+	    ::fwrite(data, 1U, length, m_fp) != length) {
+		LogError("Cannot write to the capture file, stopping the capture");
+		close();
+		return false;
+	}
+
+	m_count++;
+
+	return true;
+}
+
+void CCapture::close()
+{
+	if (m_fp == nullptr)
+		return;
+
+	::fclose(m_fp);
+	m_fp = nullptr;
+
+	LogInfo("Captured %u messages to %s", m_count, m_fileName.c_str());
+}
@@ -0,0 +1,61 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(CAPTURE_H)
+#define	CAPTURE_H
+
+#include "StopWatch.h"
+
+#include <string>
+#include <cstdio>
+
+// The file starts with the magic, then each record is a little endian
+// 32-bit time in ms since the start, the topic, a little endian 32-bit
+// length, and the payload. The low four bits of the topic say which topic
+// it is, the high four bits which instance it came from.
+const char          CAPTURE_MAGIC[]        = "DDCAP1";
+const unsigned int  CAPTURE_MAGIC_LENGTH   = 6U;
+const unsigned int  CAPTURE_HEADER_LENGTH  = 9U;
+const unsigned int  CAPTURE_MAX_LENGTH     = 65536U;
+
+const unsigned char CAPTURE_TOPIC_JSON     = 0x01U;
+const unsigned char CAPTURE_TOPIC_DISPLAY  = 0x02U;
+const unsigned char CAPTURE_TOPIC_MASK     = 0x0FU;
+
+const unsigned int  CAPTURE_INSTANCE_SHIFT = 4U;
+const unsigned int  CAPTURE_MAX_INSTANCES  = 16U;
+
+class CCapture {
+public:
+	CCapture(const std::string& fileName);
+	~CCapture();
+
+	bool open();
+
+	bool write(unsigned char topic, const unsigned char* data, unsigned int length);
+
+	void close();
+
+private:
+	std::string  m_fileName;
+	FILE*        m_fp;
+	CStopWatch   m_stopWatch;
+	unsigned int m_count;
+};
+
+#endif
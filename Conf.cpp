@@ -29,8 +29,10 @@ const int BUFFER_SIZE = 500;
 enum class SECTION {
 	NONE,
 	GENERAL,
+	INSTANCE,
 	LOG,
 	MQTT,
+	METRICS,
 	TFT_SURENOO,
 	HD44780,
 	NEXTION,
@@ -38,14 +40,17 @@ enum class SECTION {
 	LCDPROC
 };
 
-CConf::CConf(const std::string& file) :
+CConf::CConf(const std::string& file, const std::string& instance) :
 m_file(file),
+m_instance(instance),
+m_instances(),
 m_callsign(),
 m_id(0U),
 m_duplex(true),
 m_mmdvmName("mmdvm"),
 m_display("Dummy"),
 m_daemon(false),
+m_displayThread(false),
 m_logMQTTLevel(0U),
 m_logDisplayLevel(0U),
 m_mqttAddress("127.0.0.1"),
@@ -55,9 +60,16 @@ m_mqttName("display-driver"),
 m_mqttAuthEnabled(false),
 m_mqttUsername(),
 m_mqttPassword(),
+m_mqttQoS(2U),
+m_mqttTopics(),
+m_metricsEnabled(false),
+m_metricsInterval(60U),
+m_metricsPrometheusFile(),
 m_tftSurenooPort("/dev/ttyAMA0"),
 m_tftSurenooBrightness(50U),
 m_tftSurenooScreenLayout(0U),
+m_tftSurenooTelemetryInterval(250U),
+m_tftSurenooLowLatency(false),
 m_hd44780Rows(2U),
 m_hd44780Columns(16U),
 m_hd44780Pins(),
@@ -68,6 +80,7 @@ m_hd44780PWMBright(),
 m_hd44780PWMDim(),
 m_hd44780DisplayClock(false),
 m_hd44780UTC(false),
+m_hd44780TelemetryInterval(250U),
 m_nextionPort("/dev/ttyAMA0"),
 m_nextionBrightness(50U),
 m_nextionDisplayClock(false),
@@ -75,18 +88,24 @@ m_nextionUTC(false),
 m_nextionIdleBrightness(20U),
 m_nextionScreenLayout(0U),
 m_nextionTempInFahrenheit(false),
+m_nextionTelemetryInterval(250U),
+m_nextionWindow(1U),
+m_nextionBaudrate(0U),
+m_nextionLowLatency(false),
 m_oledType(3U),
 m_oledBrightness(0U),
 m_oledInvert(false),
 m_oledScroll(false),
 m_oledRotate(false),
 m_oledLogoScreensaver(true),
+m_oledTelemetryInterval(250U),
 m_lcdprocAddress(),
 m_lcdprocPort(0U),
 m_lcdprocLocalPort(0U),
 m_lcdprocDisplayClock(false),
 m_lcdprocUTC(false),
-m_lcdprocDimOnIdle(false)
+m_lcdprocDimOnIdle(false),
+m_lcdprocTelemetryInterval(250U)
 {
 }
 
@@ -110,12 +129,29 @@ bool CConf::read()
 			continue;
 
 		if (buffer[0U] == '[') {
+			// Turn [Nextion <instance>] into [Nextion] for our own instance
+			char* end = ::strchr(buffer, ']');
+			size_t len = m_instance.length();
+			if (len > 0U && end != nullptr && size_t(end - buffer) > (len + 1U) && *(end - len - 1U) == ' ' &&
+			    ::strncmp(end - len, m_instance.c_str(), len) == 0) {
+				*(end - len - 1U) = ']';
+				*(end - len)      = '\0';
+			}
+
 			if (::strncmp(buffer, "[General]", 9U) == 0)
 				section = SECTION::GENERAL;
+			else if (::strncmp(buffer, "[Instance]", 10U) == 0)
+				section = SECTION::INSTANCE;
+			else if (::strncmp(buffer, "[Instance ", 10U) == 0 && end != nullptr) {
+				m_instances.push_back(std::string(buffer + 10U, end));
+				section = SECTION::NONE;
+			}
 			else if (::strncmp(buffer, "[Log]", 5U) == 0)
 				section = SECTION::LOG;
 			else if (::strncmp(buffer, "[MQTT]", 6U) == 0)
 				section = SECTION::MQTT;
+			else if (::strncmp(buffer, "[Metrics]", 9U) == 0)
+				section = SECTION::METRICS;
 			else if (::strncmp(buffer, "[TFT Surenoo]", 13U) == 0)
 				section = SECTION::TFT_SURENOO;
 			else if (::strncmp(buffer, "[HD44780]", 9U) == 0)
@@ -157,7 +193,7 @@ bool CConf::read()
 				*p = '\0';
 		}
 
-		if (section == SECTION::GENERAL) {
+		if (section == SECTION::GENERAL || section == SECTION::INSTANCE) {
 			if (::strcmp(key, "Callsign") == 0) {
 				// Convert the callsign to upper case
 				for (unsigned int i = 0U; value[i] != 0; i++)
@@ -173,6 +209,8 @@ bool CConf::read()
 				m_display = value;
 			else if (::strcmp(key, "Daemon") == 0)
 				m_daemon = ::atoi(value) == 1;
+			else if (::strcmp(key, "DisplayThread") == 0)
+				m_displayThread = ::atoi(value) == 1;
 		} else if (section == SECTION::LOG) {
 			if (::strcmp(key, "MQTTLevel") == 0)
 				m_logMQTTLevel = (unsigned int)::atoi(value);
@@ -193,6 +231,38 @@ bool CConf::read()
 				m_mqttUsername = value;
 			else if (::strcmp(key, "Password") == 0)
 				m_mqttPassword = value;
+			else if (::strcmp(key, "QoS") == 0) {
+				m_mqttQoS = (unsigned int)::atoi(value);
+				if (m_mqttQoS > 2U)
+					m_mqttQoS = 2U;
+			}
+			else if (::strcmp(key, "Topic") == 0) {
+				char* p1 = ::strtok(value, ",\r\n");
+				char* p2 = ::strtok(nullptr, ",\r\n");
+				char* p3 = ::strtok(nullptr, ",\r\n");
+				char* p4 = ::strtok(nullptr, ",\r\n");
+				char* p5 = ::strtok(nullptr, ",\r\n");
+				if (p1 != nullptr && p2 != nullptr) {
+					CMQTTTopic topic;
+					topic.m_topic    = p1;
+					topic.m_qos      = (unsigned int)::atoi(p2);
+					if (topic.m_qos > 2U)
+						topic.m_qos = 2U;
+					topic.m_retain   = (p3 != nullptr) && ::atoi(p3) == 1;
+					topic.m_length   = (p4 != nullptr) ? (unsigned int)::atoi(p4) : 0U;
+					topic.m_overflow = (p5 != nullptr) ? (unsigned int)::atoi(p5) : 0U;
+					if (topic.m_overflow > 2U)
+						topic.m_overflow = 0U;
+					m_mqttTopics.push_back(topic);
+				}
+			}
+		} else if (section == SECTION::METRICS) {
+			if (::strcmp(key, "Enable") == 0)
+				m_metricsEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Interval") == 0)
+				m_metricsInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "PrometheusFile") == 0)
+				m_metricsPrometheusFile = value;
 		} else if (section == SECTION::TFT_SURENOO) {
 			if (::strcmp(key, "Port") == 0)
 				m_tftSurenooPort = value;
@@ -200,6 +270,10 @@ bool CConf::read()
 				m_tftSurenooBrightness = (unsigned int)::atoi(value);
 			else if (::strcmp(key, "ScreenLayout") == 0)
 				m_tftSurenooScreenLayout = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "TelemetryInterval") == 0)
+				m_tftSurenooTelemetryInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "LowLatency") == 0)
+				m_tftSurenooLowLatency = ::atoi(value) == 1;
 		} else if (section == SECTION::HD44780) {
 			if (::strcmp(key, "Rows") == 0)
 				m_hd44780Rows = (unsigned int)::atoi(value);
@@ -219,6 +293,8 @@ bool CConf::read()
 				m_hd44780DisplayClock = ::atoi(value) == 1;
 			else if (::strcmp(key, "UTC") == 0)
 				m_hd44780UTC = ::atoi(value) == 1;
+			else if (::strcmp(key, "TelemetryInterval") == 0)
+				m_hd44780TelemetryInterval = (unsigned int)::atoi(value);
 			else if (::strcmp(key, "Pins") == 0) {
 				char* p = ::strtok(value, ",\r\n");
 				while (p != nullptr) {
@@ -242,6 +318,14 @@ bool CConf::read()
 				m_nextionScreenLayout = (unsigned int)::strtoul(value, nullptr, 0);
 			else if (::strcmp(key, "DisplayTempInFahrenheit") == 0)
 				m_nextionTempInFahrenheit = ::atoi(value) == 1;
+			else if (::strcmp(key, "TelemetryInterval") == 0)
+				m_nextionTelemetryInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Window") == 0)
+				m_nextionWindow = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Baudrate") == 0)
+				m_nextionBaudrate = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "LowLatency") == 0)
+				m_nextionLowLatency = ::atoi(value) == 1;
 		} else if (section == SECTION::OLED) {
 			if (::strcmp(key, "Type") == 0)
 				m_oledType = (unsigned char)::atoi(value);
@@ -255,6 +339,8 @@ bool CConf::read()
 				m_oledRotate = ::atoi(value) == 1;
 			else if (::strcmp(key, "LogoScreensaver") == 0)
 				m_oledLogoScreensaver = ::atoi(value) == 1;
+			else if (::strcmp(key, "TelemetryInterval") == 0)
+				m_oledTelemetryInterval = (unsigned int)::atoi(value);
 		} else if (section == SECTION::LCDPROC) {
 			if (::strcmp(key, "Address") == 0)
 				m_lcdprocAddress = value;
@@ -268,6 +354,8 @@ bool CConf::read()
 				m_lcdprocUTC = ::atoi(value) == 1;
 			else if (::strcmp(key, "DimOnIdle") == 0)
 				m_lcdprocDimOnIdle = ::atoi(value) == 1;
+			else if (::strcmp(key, "TelemetryInterval") == 0)
+				m_lcdprocTelemetryInterval = (unsigned int)::atoi(value);
 		}
 	}
 
@@ -306,6 +394,16 @@ bool CConf::getDaemon() const
 	return m_daemon;
 }
 
+bool CConf::getDisplayThread() const
+{
+	return m_displayThread;
+}
+
+std::vector<std::string> CConf::getInstances() const
+{
+	return m_instances;
+}
+
 unsigned int CConf::getLogMQTTLevel() const
 {
 	return m_logMQTTLevel;
@@ -351,6 +449,31 @@ std::string CConf::getMQTTPassword() const
 	return m_mqttPassword;
 }
 
+unsigned int CConf::getMQTTQoS() const
+{
+	return m_mqttQoS;
+}
+
+std::vector<CMQTTTopic> CConf::getMQTTTopics() const
+{
+	return m_mqttTopics;
+}
+
+bool CConf::getMetricsEnabled() const
+{
+	return m_metricsEnabled;
+}
+
+unsigned int CConf::getMetricsInterval() const
+{
+	return m_metricsInterval;
+}
+
+std::string CConf::getMetricsPrometheusFile() const
+{
+	return m_metricsPrometheusFile;
+}
+
 std::string CConf::getTFTSurenooPort() const
 {
 	return m_tftSurenooPort;
@@ -366,6 +489,16 @@ unsigned int CConf::getTFTSurenooScreenLayout() const
 	return m_tftSurenooScreenLayout;
 }
 
+unsigned int CConf::getTFTSurenooTelemetryInterval() const
+{
+	return m_tftSurenooTelemetryInterval;
+}
+
+bool CConf::getTFTSurenooLowLatency() const
+{
+	return m_tftSurenooLowLatency;
+}
+
 unsigned int CConf::getHD44780Rows() const
 {
 	return m_hd44780Rows;
@@ -416,6 +549,11 @@ bool CConf::getHD44780UTC() const
 	return m_hd44780UTC;
 }
 
+unsigned int CConf::getHD44780TelemetryInterval() const
+{
+	return m_hd44780TelemetryInterval;
+}
+
 std::string CConf::getNextionPort() const
 {
 	return m_nextionPort;
@@ -476,6 +614,11 @@ bool CConf::getOLEDLogoScreensaver() const
 	return m_oledLogoScreensaver;
 }
 
+unsigned int CConf::getOLEDTelemetryInterval() const
+{
+	return m_oledTelemetryInterval;
+}
+
 std::string CConf::getLCDprocAddress() const
 {
 	return m_lcdprocAddress;
@@ -506,8 +649,33 @@ bool CConf::getLCDprocDimOnIdle() const
 	return m_lcdprocDimOnIdle;
 }
 
+unsigned int CConf::getLCDprocTelemetryInterval() const
+{
+	return m_lcdprocTelemetryInterval;
+}
+
 bool CConf::getNextionTempInFahrenheit() const
 {
 	return m_nextionTempInFahrenheit;
 }
 
+unsigned int CConf::getNextionTelemetryInterval() const
+{
+	return m_nextionTelemetryInterval;
+}
+
+unsigned int CConf::getNextionWindow() const
+{
+	return m_nextionWindow;
+}
+
+unsigned int CConf::getNextionBaudrate() const
+{
+	return m_nextionBaudrate;
+}
+
+bool CConf::getNextionLowLatency() const
+{
+	return m_nextionLowLatency;
+}
+
@@ -22,10 +22,21 @@
 #include <string>
 #include <vector>
 
+// One Topic= line from the MQTT section
+struct CMQTTTopic {
+	std::string  m_topic;
+	unsigned int m_qos;
+	bool         m_retain;
+	unsigned int m_length;
+	unsigned int m_overflow;
+};
+
 class CConf
 {
 public:
-	CConf(const std::string& file);
+	// With an instance name, [Instance <name>] is read after [General] and
+	// a section such as [Nextion <name>] is read as [Nextion]
+	CConf(const std::string& file, const std::string& instance = "");
 	~CConf();
 
 	bool read();
@@ -37,6 +48,8 @@ public:
   	std::string  getMMDVMName() const;
 	std::string  getDisplay() const;
 	bool         getDaemon() const;
+	bool         getDisplayThread() const;
+	std::vector<std::string> getInstances() const;
 
 	// The Log section
 	unsigned int getLogMQTTLevel() const;
@@ -50,11 +63,20 @@ public:
 	bool           getMQTTAuthEnabled() const;
 	std::string    getMQTTUsername() const;
 	std::string    getMQTTPassword() const;
+	unsigned int   getMQTTQoS() const;
+	std::vector<CMQTTTopic> getMQTTTopics() const;
+
+	// The Metrics section
+	bool         getMetricsEnabled() const;
+	unsigned int getMetricsInterval() const;
+	std::string  getMetricsPrometheusFile() const;
 
 	// The TFT Surenoo section
 	std::string  getTFTSurenooPort() const;
 	unsigned int getTFTSurenooBrightness() const;
 	unsigned int getTFTSurenooScreenLayout() const;
+	unsigned int getTFTSurenooTelemetryInterval() const;
+	bool         getTFTSurenooLowLatency() const;
 
 	// The HD44780 section
 	unsigned int getHD44780Rows() const;
@@ -67,6 +89,7 @@ public:
 	unsigned int getHD44780PWMDim() const;
 	bool         getHD44780DisplayClock() const;
 	bool         getHD44780UTC() const;
+	unsigned int getHD44780TelemetryInterval() const;
 
 	// The Nextion section
 	std::string  getNextionPort() const;
@@ -76,6 +99,10 @@ public:
 	unsigned int getNextionIdleBrightness() const;
 	unsigned int getNextionScreenLayout() const;
 	bool         getNextionTempInFahrenheit() const;
+	unsigned int getNextionTelemetryInterval() const;
+	unsigned int getNextionWindow() const;
+	unsigned int getNextionBaudrate() const;
+	bool         getNextionLowLatency() const;
 
 	// The OLED section
 	unsigned char  getOLEDType() const;
@@ -84,6 +111,7 @@ public:
 	bool           getOLEDScroll() const;
 	bool           getOLEDRotate() const;
 	bool           getOLEDLogoScreensaver() const;
+	unsigned int getOLEDTelemetryInterval() const;
 
 	// The LCDproc section
 	std::string  getLCDprocAddress() const;
@@ -92,15 +120,19 @@ public:
 	bool         getLCDprocDisplayClock() const;
 	bool         getLCDprocUTC() const;
 	bool         getLCDprocDimOnIdle() const;
+	unsigned int getLCDprocTelemetryInterval() const;
 
 private:
 	std::string  m_file;
+	std::string  m_instance;
+	std::vector<std::string> m_instances;
 	std::string  m_callsign;
 	unsigned int m_id;
 	bool         m_duplex;
 	std::string  m_mmdvmName;
 	std::string  m_display;
 	bool         m_daemon;
+	bool         m_displayThread;
 
 	unsigned int m_logMQTTLevel;
 	unsigned int m_logDisplayLevel;
@@ -112,10 +144,18 @@ private:
 	bool         m_mqttAuthEnabled;
 	std::string  m_mqttUsername;
 	std::string  m_mqttPassword;
+	unsigned int m_mqttQoS;
+	std::vector<CMQTTTopic> m_mqttTopics;
+
+	bool         m_metricsEnabled;
+	unsigned int m_metricsInterval;
+	std::string  m_metricsPrometheusFile;
 
 	std::string  m_tftSurenooPort;
 	unsigned int m_tftSurenooBrightness;
 	unsigned int m_tftSurenooScreenLayout;
+	unsigned int m_tftSurenooTelemetryInterval;
+	bool         m_tftSurenooLowLatency;
 
 	unsigned int m_hd44780Rows;
 	unsigned int m_hd44780Columns;
@@ -127,6 +167,7 @@ private:
 	unsigned int m_hd44780PWMDim;
 	bool         m_hd44780DisplayClock;
 	bool         m_hd44780UTC;
+	unsigned int m_hd44780TelemetryInterval;
 
 	std::string  m_nextionPort;
 	unsigned int m_nextionBrightness;
@@ -135,6 +176,10 @@ private:
 	unsigned int m_nextionIdleBrightness;
 	unsigned int m_nextionScreenLayout;
 	bool         m_nextionTempInFahrenheit;
+	unsigned int m_nextionTelemetryInterval;
+	unsigned int m_nextionWindow;
+	unsigned int m_nextionBaudrate;
+	bool         m_nextionLowLatency;
   
 	unsigned char m_oledType;
 	unsigned char m_oledBrightness;
@@ -142,6 +187,7 @@ private:
 	bool          m_oledScroll;
 	bool          m_oledRotate;
 	bool          m_oledLogoScreensaver;
+	unsigned int m_oledTelemetryInterval;
 
 	std::string  m_lcdprocAddress;
 	unsigned short m_lcdprocPort;
@@ -149,6 +195,7 @@ private:
 	bool         m_lcdprocDisplayClock;
 	bool         m_lcdprocUTC;
 	bool         m_lcdprocDimOnIdle;
+	unsigned int m_lcdprocTelemetryInterval;
 };
 
 #endif
@@ -24,9 +24,16 @@
 #include <cassert>
 #include <cstring>
 
+// How long to sleep when the display has nothing scheduled
+const unsigned int DISPLAY_IDLE_TIMEOUT = 1000U;
+
+// How long the last call stays on the display after it has ended
+const unsigned int DISPLAY_HOLD_TIME = 9000U;
+
 CDisplay::CDisplay() :
-m_timer1(3000U, 3U),
-m_timer2(3000U, 3U),
+m_timers(),
+m_timer1(m_timers, DISPLAY_HOLD_TIME, [this]() { expired1(); }),
+m_timer2(m_timers, DISPLAY_HOLD_TIME, [this]() { expired2(); }),
 m_mode1(MODE_IDLE),
 m_mode2(MODE_IDLE)
 {
@@ -307,71 +314,93 @@ void CDisplay::writeCW()
 	writeCWInt();
 }
 
-void CDisplay::clock(unsigned int ms)
+void CDisplay::clock()
 {
-	m_timer1.clock(ms);
-	if (m_timer1.isRunning() && m_timer1.hasExpired()) {
-		switch (m_mode1) {
-		case MODE_DSTAR:
-			clearDStarInt();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_DMR:
-			clearDMRInt(1U);
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_YSF:
-			clearFusionInt();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_P25:
-			clearP25Int();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_NXDN:
-			clearNXDNInt();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_POCSAG:
-			clearPOCSAGInt();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_FM:
-			clearFMInt();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		case MODE_CW:
-			clearCWInt();
-			m_mode1 = MODE_IDLE;
-			m_timer1.stop();
-			break;
-		default:
-			break;
-		}
+	m_timers.run();
+
+	clockInt();
+}
+
+unsigned int CDisplay::getTimeout()
+{
+	return m_timers.nextDeadline(getTimeoutInt());
+}
+
+void CDisplay::expired1()
+{
+	switch (m_mode1) {
+	case MODE_DSTAR:
+		clearDStarInt();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_DMR:
+		clearDMRInt(1U);
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_YSF:
+		clearFusionInt();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_P25:
+		clearP25Int();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_NXDN:
+		clearNXDNInt();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_POCSAG:
+		clearPOCSAGInt();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_FM:
+		clearFMInt();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	case MODE_CW:
+		clearCWInt();
+		m_mode1 = MODE_IDLE;
+		m_timer1.stop();
+		break;
+	default:
+		break;
 	}
+}
 
+void CDisplay::expired2()
+{
 	// Timer/mode 2 are only used for DMR
-	m_timer2.clock(ms);
-	if (m_timer2.isRunning() && m_timer2.hasExpired()) {
-		if (m_mode2 == MODE_DMR) {
-			clearDMRInt(2U);
-			m_mode2 = MODE_IDLE;
-			m_timer2.stop();
-		}
+	if (m_mode2 == MODE_DMR) {
+		clearDMRInt(2U);
+		m_mode2 = MODE_IDLE;
+		m_timer2.stop();
 	}
+}
 
-	clockInt(ms);
+int CDisplay::getFD() const
+{
+	return -1;
+}
+
+bool CDisplay::wantWrite() const
+{
+	return false;
+}
+
+void CDisplay::clockInt()
+{
 }
 
-void CDisplay::clockInt(unsigned int ms)
+unsigned int CDisplay::getTimeoutInt()
 {
+	return DISPLAY_IDLE_TIMEOUT;
 }
 
 void CDisplay::writeDStarRSSIInt(int rssi)
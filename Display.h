@@ -19,6 +19,7 @@
 #if !defined(DISPLAY_H)
 #define	DISPLAY_H
 
+#include "TimerService.h"
 #include "Timer.h"
 
 #include <string>
@@ -78,9 +79,23 @@ public:
 
 	virtual void close() = 0;
 
-	void clock(unsigned int ms);
+	// Runs the timers that are due and then the display's own work
+	void clock();
+
+	// The number of milliseconds until clock() next has work to do
+	unsigned int getTimeout();
+
+	// A descriptor whose readiness means clock() has data to process
+	virtual int getFD() const;
+
+	// True when clock() is waiting for the descriptor to become writable
+	virtual bool wantWrite() const;
 
 protected:
+	// So that an event which has already been through the hold timers of
+	// another CDisplay can be passed straight to these
+	friend class CDisplayEvent;
+
 	virtual void setIdleInt() = 0;
 	virtual void setLockoutInt() = 0;
 	virtual void setErrorInt() = 0;
@@ -123,13 +138,21 @@ protected:
 	virtual void writeCWInt() = 0;
 	virtual void clearCWInt() = 0;
 
-	virtual void clockInt(unsigned int ms);
+	virtual void clockInt();
+	virtual unsigned int getTimeoutInt();
+
+	// Every timer of the display runs on this, so that they all run on the
+	// thread that clocks the display
+	CTimerService m_timers;
 
 private:
 	CTimer        m_timer1;
 	CTimer        m_timer2;
 	unsigned char m_mode1;
 	unsigned char m_mode2;
+
+	void expired1();
+	void expired2();
 };
 
 #endif
@@ -0,0 +1,181 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DisplayCoalescer.h"
+
+#include <cassert>
+
+// The slot used to hold the newest value of each telemetry field
+const unsigned int SLOT_DSTAR_RSSI  = 0U;
+const unsigned int SLOT_DSTAR_BER   = 1U;
+const unsigned int SLOT_DSTAR_TEXT  = 2U;
+const unsigned int SLOT_DMR1_RSSI   = 3U;
+const unsigned int SLOT_DMR1_BER    = 4U;
+const unsigned int SLOT_DMR1_TA     = 5U;
+const unsigned int SLOT_DMR2_RSSI   = 6U;
+const unsigned int SLOT_DMR2_BER    = 7U;
+const unsigned int SLOT_DMR2_TA     = 8U;
+const unsigned int SLOT_FUSION_RSSI = 9U;
+const unsigned int SLOT_FUSION_BER  = 10U;
+const unsigned int SLOT_P25_RSSI    = 11U;
+const unsigned int SLOT_P25_BER     = 12U;
+const unsigned int SLOT_NXDN_RSSI   = 13U;
+const unsigned int SLOT_NXDN_BER    = 14U;
+const unsigned int SLOT_FM_RSSI     = 15U;
+const unsigned int SLOT_NONE        = 16U;
+
+static unsigned int getSlot(const CDisplayEvent& event)
+{
+	// DMR slot 1 and slot 2 are kept apart, anything else is treated as slot 1
+	unsigned int dmr = event.m_slotNo == 2U ? 3U : 0U;
+
+	switch (event.m_event) {
+		case DISPLAY_EVENT::WRITE_DSTAR_RSSI:  return SLOT_DSTAR_RSSI;
+		case DISPLAY_EVENT::WRITE_DSTAR_BER:   return SLOT_DSTAR_BER;
+		case DISPLAY_EVENT::WRITE_DSTAR_TEXT:  return SLOT_DSTAR_TEXT;
+		case DISPLAY_EVENT::WRITE_DMR_RSSI:    return SLOT_DMR1_RSSI + dmr;
+		case DISPLAY_EVENT::WRITE_DMR_BER:     return SLOT_DMR1_BER + dmr;
+		case DISPLAY_EVENT::WRITE_DMR_TA:      return SLOT_DMR1_TA + dmr;
+		case DISPLAY_EVENT::WRITE_FUSION_RSSI: return SLOT_FUSION_RSSI;
+		case DISPLAY_EVENT::WRITE_FUSION_BER:  return SLOT_FUSION_BER;
+		case DISPLAY_EVENT::WRITE_P25_RSSI:    return SLOT_P25_RSSI;
+		case DISPLAY_EVENT::WRITE_P25_BER:     return SLOT_P25_BER;
+		case DISPLAY_EVENT::WRITE_NXDN_RSSI:   return SLOT_NXDN_RSSI;
+		case DISPLAY_EVENT::WRITE_NXDN_BER:    return SLOT_NXDN_BER;
+		case DISPLAY_EVENT::WRITE_FM_RSSI:     return SLOT_FM_RSSI;
+		default:                               return SLOT_NONE;
+	}
+}
+
+CDisplayCoalescer::CDisplayCoalescer(CTimerService& service, unsigned int interval) :
+m_timer(service, interval),
+m_events(),
+m_held(),
+m_count(0U),
+m_flushed(false)
+{
+	assert(interval > 0U);
+}
+
+CDisplayCoalescer::~CDisplayCoalescer()
+{
+}
+
+bool CDisplayCoalescer::add(const CDisplayEvent& event)
+{
+	unsigned int slot = getSlot(event);
+	if (slot == SLOT_NONE) {
+		discard(event);
+		return false;
+	}
+
+	// Nothing sent recently, so send this one now and hold back any that follow
+	bool open = m_timer.isRunning() && !m_timer.hasExpired();
+	if (!open && m_count == 0U) {
+		m_timer.start();
+		return false;
+	}
+
+	if (!m_held[slot]) {
+		m_held[slot] = true;
+		m_count++;
+	}
+
+	m_events[slot] = event;
+
+	return true;
+}
+
+bool CDisplayCoalescer::get(CDisplayEvent& event)
+{
+	if (!m_timer.isRunning() || !m_timer.hasExpired())
+		return false;
+
+	if (m_count > 0U) {
+		for (unsigned int i = 0U; i < COALESCER_SLOTS; i++) {
+			if (m_held[i]) {
+				event     = m_events[i];
+				m_held[i] = false;
+				m_count--;
+				m_flushed = true;
+				return true;
+			}
+		}
+	}
+
+	// Anything arriving within an interval of this flush is held back again
+	if (m_flushed)
+		m_timer.start();
+	else
+		m_timer.stop();
+
+	m_flushed = false;
+
+	return false;
+}
+
+void CDisplayCoalescer::discard(unsigned int first, unsigned int last)
+{
+	for (unsigned int i = first; i <= last; i++) {
+		if (m_held[i]) {
+			m_held[i] = false;
+			m_count--;
+		}
+	}
+}
+
+void CDisplayCoalescer::discard(const CDisplayEvent& event)
+{
+	// Held values belong to the call that is starting or ending here
+	switch (event.m_event) {
+		case DISPLAY_EVENT::WRITE_DSTAR:
+		case DISPLAY_EVENT::CLEAR_DSTAR:
+			discard(SLOT_DSTAR_RSSI, SLOT_DSTAR_TEXT);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR:
+		case DISPLAY_EVENT::CLEAR_DMR:
+			if (event.m_slotNo == 2U)
+				discard(SLOT_DMR2_RSSI, SLOT_DMR2_TA);
+			else
+				discard(SLOT_DMR1_RSSI, SLOT_DMR1_TA);
+			break;
+		case DISPLAY_EVENT::WRITE_FUSION:
+		case DISPLAY_EVENT::CLEAR_FUSION:
+			discard(SLOT_FUSION_RSSI, SLOT_FUSION_BER);
+			break;
+		case DISPLAY_EVENT::WRITE_P25:
+		case DISPLAY_EVENT::CLEAR_P25:
+			discard(SLOT_P25_RSSI, SLOT_P25_BER);
+			break;
+		case DISPLAY_EVENT::WRITE_NXDN:
+		case DISPLAY_EVENT::CLEAR_NXDN:
+			discard(SLOT_NXDN_RSSI, SLOT_NXDN_BER);
+			break;
+		case DISPLAY_EVENT::WRITE_FM:
+		case DISPLAY_EVENT::CLEAR_FM:
+			discard(SLOT_FM_RSSI, SLOT_FM_RSSI);
+			break;
+		case DISPLAY_EVENT::WRITE_POCSAG:
+		case DISPLAY_EVENT::CLEAR_POCSAG:
+			break;
+		default:
+			// A change of mode makes everything held stale
+			discard(SLOT_DSTAR_RSSI, SLOT_FM_RSSI);
+			break;
+	}
+}
@@ -0,0 +1,53 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DISPLAYCOALESCER_H)
+#define	DISPLAYCOALESCER_H
+
+#include "DisplayEvent.h"
+#include "Timer.h"
+
+const unsigned int COALESCER_SLOTS = 17U;
+
+// Holds back RSSI, BER and text updates so that no more than one of each
+// reaches the display per interval, only the newest value is kept. All
+// other events pass straight through and discard any stale held values.
+// The interval runs on the service of the thread that calls get().
+class CDisplayCoalescer {
+public:
+	CDisplayCoalescer(CTimerService& service, unsigned int interval);
+	~CDisplayCoalescer();
+
+	// Returns true if the event has been held back, to be returned by get()
+	bool add(const CDisplayEvent& event);
+
+	// Returns the held events, one at a time, once they are due
+	bool get(CDisplayEvent& event);
+
+private:
+	CTimer        m_timer;
+	CDisplayEvent m_events[COALESCER_SLOTS];
+	bool          m_held[COALESCER_SLOTS];
+	unsigned int  m_count;
+	bool          m_flushed;
+
+	void discard(unsigned int first, unsigned int last);
+	void discard(const CDisplayEvent& event);
+};
+
+#endif
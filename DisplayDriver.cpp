@@ -18,28 +18,17 @@
 
 #include "DisplayDriver.h"
 #include "MQTTConnection.h"
-#include "UARTController.h"
-#include "TFTSurenoo.h"
 #include "StopWatch.h"
-#include "LCDproc.h"
-#include "Nextion.h"
+#include "Metrics.h"
 #include "Version.h"
 #include "Defines.h"
-#include "Dummy.h"
 #include "Thread.h"
+#include "Timer.h"
 #include "Utils.h"
 #include "Conf.h"
 #include "Log.h"
 #include "GitVersion.h"
 
-#if defined(USE_HD44780)
-#include "HD44780.h"
-#endif
-
-#if defined(USE_OLED)
-#include "OLED.h"
-#endif
-
 #include <cstdio>
 #include <vector>
 
@@ -59,6 +48,9 @@ const char* DEFAULT_INI_FILE = "DisplayDriver.ini";
 const char* DEFAULT_INI_FILE = "/etc/DisplayDriver.ini";
 #endif
 
+// The longest the main loop will sleep for when nothing is happening
+const unsigned int MAX_WAIT_TIMEOUT = 1000U;
+
 static bool m_killed = false;
 static int  m_signal = 0;
 static bool m_reload = false;
@@ -84,14 +76,23 @@ static void sigHandler2(int signum)
 int main(int argc, char** argv)
 {
 	const char* iniFile = DEFAULT_INI_FILE;
+	std::string captureFile;
+	std::string replayFile;
+	bool fast = false;
 	if (argc > 1) {
  		for (int currentArg = 1; currentArg < argc; ++currentArg) {
 			std::string arg = argv[currentArg];
 			if ((arg == "-v") || (arg == "--version")) {
 				::fprintf(stdout, "DisplayDriver version %s git #%.7s\n", VERSION, gitversion);
 				return 0;
+			} else if (((arg == "-c") || (arg == "--capture")) && (currentArg + 1) < argc) {
+				captureFile = argv[++currentArg];
+			} else if (((arg == "-r") || (arg == "--replay")) && (currentArg + 1) < argc) {
+				replayFile = argv[++currentArg];
+			} else if ((arg == "-f") || (arg == "--fast")) {
+				fast = true;
 			} else if (arg.substr(0,1) == "-") {
-				::fprintf(stderr, "Usage: DisplayDriver [-v|--version] [filename]\n");
+				::fprintf(stderr, "Usage: DisplayDriver [-v|--version] [-c|--capture file] [-r|--replay file [-f|--fast]] [filename]\n");
 				return 1;
 			} else {
 				iniFile = argv[currentArg];
@@ -111,11 +112,14 @@ int main(int argc, char** argv)
 	do {
 		m_signal = 0;
 
-		driver = new CDisplayDriver(std::string(iniFile));
+		driver = new CDisplayDriver(std::string(iniFile), captureFile, replayFile, fast);
 		ret = driver->run();
 		delete driver;
 
 		switch (m_signal) {
+			case 0:
+				::LogInfo("DisplayDriver-%s exited", VERSION);
+				break;
 			case 2:
 				::LogInfo("DisplayDriver-%s exited on receipt of SIGINT", VERSION);
 				break;
@@ -139,15 +143,25 @@ int main(int argc, char** argv)
 	return ret;
 }
 
-CDisplayDriver::CDisplayDriver(const std::string& confFile) :
+CDisplayDriver::CDisplayDriver(const std::string& confFile, const std::string& captureFile, const std::string& replayFile, bool fast) :
+m_confFile(confFile),
 m_conf(confFile),
-m_display(nullptr),
-m_msp(nullptr)
+m_captureFile(captureFile),
+m_replayFile(replayFile),
+m_fast(fast),
+m_instances(),
+m_capture(nullptr),
+m_replay(nullptr),
+m_replayWatch(),
+m_replayCount(0U),
+m_poller()
 {
 }
 
 CDisplayDriver::~CDisplayDriver()
 {
+	for (auto& it : m_instances)
+		delete it;
 }
 
 int CDisplayDriver::run()
@@ -218,27 +232,17 @@ int CDisplayDriver::run()
 #endif
 #endif
 	::LogInitialise(m_conf.getLogDisplayLevel(), m_conf.getLogMQTTLevel());
+	::MetricsInitialise(m_conf.getMetricsEnabled());
 
-	const std::string displayName = m_conf.getMMDVMName() + "/display-out";
-	const std::string jsonName    = m_conf.getMMDVMName() + "/json";
-
-	std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>> subscriptions;
-	subscriptions.push_back(std::make_pair(displayName, CDisplayDriver::onDisplay));
-	subscriptions.push_back(std::make_pair(jsonName,    CDisplayDriver::onJSON));
-
-	m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive());
-	ret = m_mqtt->open();
-	if (!ret) {
-		::fprintf(stderr, "DisplayDriver: unable to start the MQTT Publisher\n");
-		delete m_mqtt;
+	ret = createInstances();
+	if (!ret)
 		return 1;
-	}
 
-	// Pump the MQTT loop until connected (CONNACK received) so that
-	// the display startup commands don't get silently dropped.
-	for (unsigned int i = 0U; i < 50U && !m_mqtt->isConnected(); i++) {
-		m_mqtt->loop();
-		CThread::sleep(100U);
+	// A replay needs no broker, the messages come from the file instead
+	if (m_replayFile.empty()) {
+		ret = createMQTT();
+		if (!ret)
+			return 1;
 	}
 
 #if !defined(_WIN32) && !defined(_WIN64)
@@ -252,633 +256,300 @@ int CDisplayDriver::run()
 
 	writeJSONMessage("DisplayDriver is starting");
 
-	ret = createDisplay();
-	if (!ret)
-		return 1;
-
-	CStopWatch stopWatch;
-	stopWatch.start();
-
-	while (!m_killed) {
-		unsigned int ms = stopWatch.elapsed();
-		stopWatch.start();
-
-		m_display->clock(ms);
-
-		// Drive MQTT I/O from the main loop (non-threaded) to
-		// avoid the auto-reconnect race that causes client ID
-		// collisions and a connect/disconnect loop.
-		if (m_mqtt != nullptr)
-			m_mqtt->loop();
-
-		if (ms < 10U)
-			CThread::sleep(10U);
+	for (unsigned int i = 0U; i < m_instances.size(); i++) {
+		ret = m_instances.at(i)->open();
+		if (!ret) {
+			while (i > 0U)
+				m_instances.at(--i)->close();
+			return 1;
+		}
 	}
 
-	LogInfo("DisplayDriver is stopping");
-	writeJSONMessage("DisplayDriver is stopping");
-
-	m_display->close();
-	delete m_display;
-
-	return 0;
-}
-
-bool CDisplayDriver::createDisplay()
-{
-	std::string type = m_conf.getDisplay();
-
-	LogInfo("Display Parameters");
-	LogInfo("    Type: %s", type.c_str());
-
-	if (type == "TFTSurenoo") {
-		std::string port          = m_conf.getTFTSurenooPort();
-		unsigned int brightness   = m_conf.getTFTSurenooBrightness();
-		unsigned int screenLayout = m_conf.getTFTSurenooScreenLayout();
-
-		LogInfo("    Port: %s", port.c_str());
-		LogInfo("    Brightness: %u", brightness);
-		LogInfo("    Screen Layout: %u", screenLayout);
-
-		ISerialPort* serial = nullptr;
-		if (port == "modem")
-			serial = m_msp = new CModemSerialPort(m_conf.getMMDVMName());
-		else
-			serial = new CUARTController(port, 115200U);
-
-		m_display = new CTFTSurenoo(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), serial, brightness, screenLayout);
-	} else if (type == "Nextion") {
-		std::string port            = m_conf.getNextionPort();
-		unsigned int brightness     = m_conf.getNextionBrightness();
-		bool displayClock           = m_conf.getNextionDisplayClock();
-		bool utc                    = m_conf.getNextionUTC();
-		unsigned int idleBrightness = m_conf.getNextionIdleBrightness();
-		unsigned int screenLayout   = m_conf.getNextionScreenLayout();
-		bool displayTempInF         = m_conf.getNextionTempInFahrenheit();
-
-		LogInfo("    Port: %s", port.c_str());
-		LogInfo("    Brightness: %u", brightness);
-		LogInfo("    Clock Display: %s", displayClock ? "yes" : "no");
-		if (displayClock)
-			LogInfo("    Display UTC: %s", utc ? "yes" : "no");
-		LogInfo("    Idle Brightness: %u", idleBrightness);
-		LogInfo("    Temperature in Fahrenheit: %s ", displayTempInF ? "yes" : "no");
- 
-		switch (screenLayout) {
-		case 0U:
-			LogInfo("    Screen Layout: G4KLX (Default)");
-			break;
-		case 2U:
-			LogInfo("    Screen Layout: ON7LDS");
-			break;
-		case 3U:
-			LogInfo("    Screen Layout: DIY by ON7LDS");
-			break;
-		case 4U:
-			LogInfo("    Screen Layout: DIY by ON7LDS (High speed)");
-			break;
-		default:
-			LogInfo("    Screen Layout: %u (Unknown)", screenLayout);
-			break;
+	if (!m_captureFile.empty()) {
+		m_capture = new CCapture(m_captureFile);
+		ret = m_capture->open();
+		if (!ret) {
+			delete m_capture;
+			m_capture = nullptr;
 		}
+	}
 
-		if (port == "modem") {
-			ISerialPort* serial = m_msp = new CModemSerialPort(m_conf.getMMDVMName());
-			m_display = new CNextion(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), serial, brightness, displayClock, utc, idleBrightness, screenLayout, displayTempInF);
-		} else {
-			unsigned int baudrate = 9600U;
-			if (screenLayout == 4U)
-				baudrate = 115200U;
-			
-			LogInfo("    Display baudrate: %u ", baudrate);
-			ISerialPort* serial = new CUARTController(port, baudrate);
-			m_display = new CNextion(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), serial, brightness, displayClock, utc, idleBrightness, screenLayout, displayTempInF);
-		}
-	} else if (type == "LCDproc") {
-		std::string address       = m_conf.getLCDprocAddress();
-		unsigned int port         = m_conf.getLCDprocPort();
-		unsigned int localPort    = m_conf.getLCDprocLocalPort();
-		bool displayClock         = m_conf.getLCDprocDisplayClock();
-		bool utc                  = m_conf.getLCDprocUTC();
-		bool dimOnIdle            = m_conf.getLCDprocDimOnIdle();
-
-		LogInfo("    Address: %s", address.c_str());
-		LogInfo("    Port: %u", port);
-
-		if (localPort == 0U)
-			LogInfo("    Local Port: random");
-		else
-			LogInfo("    Local Port: %u", localPort);
-
-		LogInfo("    Dim Display on Idle: %s", dimOnIdle ? "yes" : "no");
-		LogInfo("    Clock Display: %s", displayClock ? "yes" : "no");
-
-		if (displayClock)
-			LogInfo("    Display UTC: %s", utc ? "yes" : "no");
-
-		m_display = new CLCDproc(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), address, port, localPort, displayClock, utc, dimOnIdle);
-#if defined(USE_HD44780)
-	} else if (type == "HD44780") {
-		unsigned int rows              = m_conf.getHD44780Rows();
-		unsigned int columns           = m_conf.getHD44780Columns();
-		std::vector<unsigned int> pins = m_conf.getHD44780Pins();
-		unsigned int i2cAddress        = m_conf.getHD44780i2cAddress();
-		bool pwm                       = m_conf.getHD44780PWM();
-		unsigned int pwmPin            = m_conf.getHD44780PWMPin();
-		unsigned int pwmBright         = m_conf.getHD44780PWMBright();
-		unsigned int pwmDim            = m_conf.getHD44780PWMDim();
-		bool displayClock              = m_conf.getHD44780DisplayClock();
-		bool utc                       = m_conf.getHD44780UTC();
-
-		if (pins.size() == 6U) {
-			LogInfo("    Rows: %u", rows);
-			LogInfo("    Columns: %u", columns);
-
-#if defined(USE_ADAFRUIT_DISPLAY) || defined(USE_PCF8574_DISPLAY)
-			LogInfo("    Device Address: %#x", i2cAddress);
-#else
-			LogInfo("    Pins: %u,%u,%u,%u,%u,%u", pins.at(0U), pins.at(1U), pins.at(2U), pins.at(3U), pins.at(4U), pins.at(5U));
-#endif
+	if (!m_replayFile.empty()) {
+		m_replay = new CReplay(m_replayFile);
+		ret = m_replay->open();
+		if (!ret) {
+			delete m_replay;
+			m_replay = nullptr;
 
-			LogInfo("    PWM Backlight: %s", pwm ? "yes" : "no");
-			if (pwm) {
-				LogInfo("    PWM Pin: %u", pwmPin);
-				LogInfo("    PWM Bright: %u", pwmBright);
-				LogInfo("    PWM Dim: %u", pwmDim);
+			if (m_capture != nullptr) {
+				m_capture->close();
+				delete m_capture;
+				m_capture = nullptr;
 			}
 
-			LogInfo("    Clock Display: %s", displayClock ? "yes" : "no");
-			if (displayClock)
-				LogInfo("    Display UTC: %s", utc ? "yes" : "no");
-
-			m_display = new CHD44780(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), rows, columns, pins, i2cAddress, pwm, pwmPin, pwmBright, pwmDim, displayClock, utc);
+			for (auto& it : m_instances)
+				it->close();
+			return 1;
 		}
-#endif
-#if defined(USE_OLED)
-	} else if (type == "OLED") {
-		unsigned char type       = m_conf.getOLEDType();
-		unsigned char brightness = m_conf.getOLEDBrightness();
-		bool          invert     = m_conf.getOLEDInvert();
-		bool          scroll     = m_conf.getOLEDScroll();
-		bool          rotate     = m_conf.getOLEDRotate();
-		bool          logosaver  = m_conf.getOLEDLogoScreensaver();
-
-		m_display = new COLED(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), type, brightness, invert, scroll, rotate, logosaver);
-#endif
-	} else if (type == "Dummy") {
-		m_display = new CDummy;
-	} else {
-		LogError("No valid display found");
-		return false;
-	}
 
-	bool ret = m_display->open();
-	if (!ret) {
-		delete m_display;
-		return false;
+		if (m_fast)
+			LogInfo("Replaying as fast as possible");
 	}
 
-	return true;
-}
-
-void CDisplayDriver::writeJSONMessage(const std::string& message)
-{
-	nlohmann::json json;
-
-	json["timestamp"] = CUtils::createTimestamp();
-	json["message"]   = message;
-
-	WriteJSON("status", json);
-}
+	CTimer metricsTimer(m_timers, m_conf.getMetricsInterval() * 1000U);
+	if (m_conf.getMetricsEnabled() && m_conf.getMetricsInterval() > 0U)
+		metricsTimer.start();
 
-void CDisplayDriver::readDisplay(const unsigned char* data, unsigned int length)
-{
-	assert(data != nullptr);
-	assert(length > 0U);
+	if (m_replay != nullptr) {
+		m_replayWatch.start();
+		m_replayCount = 0U;
 
-	if (m_msp != nullptr)
-		m_msp->readData(data, length);
-}
-
-void CDisplayDriver::readJSON(const std::string& text)
-{
-	LogDebug("Incoming JSON - \"%s\"", text.c_str());
-
-	try {
-		nlohmann::json j = nlohmann::json::parse(text);
-
-		if (j.contains("MMDVM") && j["MMDVM"].is_object()) {
-			LogDebug("Identified as an MMDVM message");
-			parseMMDVM(j["MMDVM"]);
-			return;
-		}
-
-		if (j.contains("RSSI") && j["RSSI"].is_object()) {
-			LogDebug("Identified as an RSSI message");
-			parseRSSI(j["RSSI"]);
-			return;
-		}
+		// Nothing to replay
+		if (!m_replay->read())
+			m_killed = true;
+	}
 
-		if (j.contains("BER") && j["BER"].is_object()) {
-			LogDebug("Identified as a BER message");
-			parseBER(j["BER"]);
-			return;
-		}
+	while (!m_killed) {
+		unsigned long long loopStart = ::MetricsNow();
 
-		if (j.contains("Text") && j["Text"].is_object()) {
-			LogDebug("Identified as a Text message");
-			parseText(j["Text"]);
-			return;
-		}
+		m_timers.run();
 
-		if (j.contains("D-Star") && j["D-Star"].is_object()) {
-			LogDebug("Identified as a D-Star message");
-			parseDStar(j["D-Star"]);
-			return;
-		}
+		for (auto& it : m_instances)
+			it->clock();
 
-		if (j.contains("DMR") && j["DMR"].is_object()) {
-			LogDebug("Identified as a DMR message");
-			parseDMR(j["DMR"]);
-			return;
+		// Drive MQTT I/O from the main loop (non-threaded) to
+		// avoid the auto-reconnect race that causes client ID
+		// collisions and a connect/disconnect loop.
+		if (m_replay != nullptr) {
+			if (!replay())
+				break;
+		} else if (m_mqtt != nullptr) {
+			m_mqtt->loop();
 		}
 
-		if (j.contains("YSF") && j["YSF"].is_object()) {
-			LogDebug("Identified as a YSF message");
-			parseYSF(j["YSF"]);
-			return;
+		if (metricsTimer.hasExpired()) {
+			::MetricsWrite(m_conf.getMetricsPrometheusFile());
+			metricsTimer.start();
 		}
 
-		if (j.contains("P25") && j["P25"].is_object()) {
-			LogDebug("Identified as a P25 message");
-			parseP25(j["P25"]);
-			return;
-		}
+		::MetricsTime(METRIC_TIME::MAIN_LOOP, ::MetricsNow() - loopStart);
 
-		if (j.contains("NXDN") && j["NXDN"].is_object()) {
-			LogDebug("Identified as an NXDN message");
-			parseNXDN(j["NXDN"]);
-			return;
-		}
+		wait();
+	}
 
-		if (j.contains("POCSAG") && j["POCSAG"].is_object()) {
-			LogDebug("Identified as a POCSAG message");
-			parsePOCSAG(j["POCSAG"]);
-			return;
-		}
+	LogInfo("DisplayDriver is stopping");
+	writeJSONMessage("DisplayDriver is stopping");
 
-		if (j.contains("FM") && j["FM"].is_object()) {
-			LogDebug("Identified as an FM message");
-			parseFM(j["FM"]);
-			return;
-		}
+	if (m_capture != nullptr) {
+		m_capture->close();
+		delete m_capture;
+		m_capture = nullptr;
 	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing: \"%s\" - %s", text.c_str(), ex.what());
-	}
-}
 
-void CDisplayDriver::parseMMDVM(const nlohmann::json& json)
-{
-	assert(m_display != nullptr);
-
-	try {
-		// We're only interested in the mode messages
-		bool hasMode = json.contains("mode");
-		if (hasMode) {
-			std::string mode = json["mode"];
-
-			if (mode == "idle")
-				m_display->setIdle();
-			else if (mode == "CW")
-				m_display->writeCW();
-			else if (mode == "lockout") 
-				m_display->setLockout();
-			else if (mode == "error")
-				m_display->setError();
-		}
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing MMDVM - %s", ex.what());
+	if (m_replay != nullptr) {
+		m_replay->close();
+		delete m_replay;
+		m_replay = nullptr;
 	}
-}
 
-void CDisplayDriver::parseRSSI(const nlohmann::json& json)
-{
-	assert(m_display != nullptr);
-
-	try {
-		if (!json.contains("mode") || !json.contains("value"))
-			return;
+	for (auto& it : m_instances)
+		it->close();
 
-		std::string mode = json["mode"];
-		int value        = json["value"];
-
-		if (mode == "D-Star") {
-			m_display->writeDStarRSSI(value);
-		} else if (mode == "DMR") {
-			if (!json.contains("slot"))
-				return;
-			int slot = json["slot"];
-			m_display->writeDMRRSSI(slot, value);
-		} else if (mode == "YSF") {
-			m_display->writeFusionRSSI(value);
-		} else if (mode == "P25") {
-			m_display->writeP25RSSI(value);
-		} else if (mode == "NXDN") {
-			m_display->writeNXDNRSSI(value);
-		} else if (mode == "FM") {
-			m_display->writeFMRSSI(value);
-		}
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing RSSI - %s", ex.what());
-	}
+	return 0;
 }
 
-void CDisplayDriver::parseBER(const nlohmann::json& json)
+bool CDisplayDriver::createMQTT()
 {
-	assert(m_display != nullptr);
-
-	try {
-		if (!json.contains("mode") || !json.contains("value"))
-			return;
+	std::vector<std::pair<std::string, MQTTHandler>> subscriptions;
+	for (unsigned int n = 0U; n < m_instances.size(); n++) {
+		const std::string displayName = m_instances.at(n)->getMMDVMName() + "/display-out";
+		const std::string jsonName    = m_instances.at(n)->getMMDVMName() + "/json";
 
-		std::string mode = json["mode"];
-		float value      = json["value"];
-
-		if (mode == "D-Star") {
-			m_display->writeDStarBER(value);
-		} else if (mode == "DMR") {
-			if (!json.contains("slot"))
-				return;
-			int slot = json["slot"];
-			m_display->writeDMRBER(slot, value);
-		} else if (mode == "YSF") {
-			m_display->writeFusionBER(value);
-		} else if (mode == "P25") {
-			m_display->writeP25BER(value);
-		} else if (mode == "NXDN") {
-			m_display->writeNXDNBER(value);
-		}
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing BER - %s", ex.what());
+		subscriptions.push_back(std::make_pair(displayName, MQTTHandler([this, n](const unsigned char* data, unsigned int length) { onDisplay(n, data, length); })));
+		subscriptions.push_back(std::make_pair(jsonName,    MQTTHandler([this, n](const unsigned char* data, unsigned int length) { onJSON(n, data, length); })));
 	}
-}
 
-void CDisplayDriver::parseText(const nlohmann::json& json)
-{
-	assert(m_display != nullptr);
+	m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive(), MQTT_QOS(m_conf.getMQTTQoS()));
 
-	try {
-		if (!json.contains("mode") || !json.contains("value"))
-			return;
+	std::vector<CMQTTTopic> topics = m_conf.getMQTTTopics();
+	for (const auto& it : topics)
+		m_mqtt->setPolicy(it.m_topic, MQTT_QOS(it.m_qos), it.m_retain, it.m_length, MQTT_OVERFLOW(it.m_overflow));
 
-		std::string mode = json["mode"];
-		if (mode == "D-Star") {
-			std::string value = json["value"];
-			m_display->writeDStarText(value);
-		} else if (mode == "DMR") {
-			if (!json.contains("slot"))
-				return;
-			int slot          = json["slot"];
-			std::string value = json["value"];
-			m_display->writeDMRTA(slot, value);
-		}
+	bool ret = m_mqtt->open();
+	if (!ret) {
+		::fprintf(stderr, "DisplayDriver: unable to start the MQTT Publisher\n");
+		delete m_mqtt;
+		m_mqtt = nullptr;
+		return false;
 	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing Text - %s", ex.what());
+
+	// Pump the MQTT loop until connected (CONNACK received) so that
+	// the display startup commands don't get silently dropped.
+	for (unsigned int i = 0U; i < 50U && !m_mqtt->isConnected(); i++) {
+		m_mqtt->loop();
+		CThread::sleep(100U);
 	}
+
+	return true;
 }
 
-void CDisplayDriver::parseDStar(const nlohmann::json& json)
+bool CDisplayDriver::createInstances()
 {
-	assert(m_display != nullptr);
+	std::vector<std::string> instances = m_conf.getInstances();
 
-	try {
-		if (!json.contains("action"))
-			return;
+	// Without any [Instance] sections the whole file describes the one instance
+	if (instances.empty()) {
+		m_instances.push_back(new CDisplayInstance(m_conf, "", m_timers));
+		return true;
+	}
 
-		std::string action = json["action"];
-		if (action == "start" || action == "late_entry") {
-			if (!json.contains("source_cs") || !json.contains("source_ext") ||
-			    !json.contains("destination_cs") || !json.contains("source"))
-				return;
-
-			std::string source_cs      = json["source_cs"];
-			std::string source_ext     = json["source_ext"];
-			std::string destination_cs = json["destination_cs"];
-			std::string reflector      = json.value("reflector", std::string());
-			std::string source         = json["source"] == "rf" ? "R" : "N";
-
-			m_display->writeDStar(source_cs, source_ext, destination_cs, source, reflector);
-		} else if (action == "end" || action == "lost") {
-			m_display->clearDStar();
-		}
+	if (instances.size() > CAPTURE_MAX_INSTANCES) {
+		::fprintf(stderr, "DisplayDriver: no more than %u instances are allowed\n", CAPTURE_MAX_INSTANCES);
+		return false;
 	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing D-Star - %s", ex.what());
+
+	for (const auto& it : instances) {
+		CConf conf(m_confFile, it);
+		if (!conf.read()) {
+			::fprintf(stderr, "DisplayDriver: cannot read the .ini file for instance %s\n", it.c_str());
+			return false;
+		}
+
+		m_instances.push_back(new CDisplayInstance(conf, it, m_timers));
 	}
+
+	return true;
 }
 
-void CDisplayDriver::parseDMR(const nlohmann::json& json)
+void CDisplayDriver::wait()
 {
-	assert(m_display != nullptr);
-
-	try {
-		if (!json.contains("action"))
+	// Sleep until a display has work scheduled, or until any of the
+	// MQTT socket or the displays' own ports has something for us. When
+	// a display has its own thread only the MQTT socket is ours.
+	unsigned int timeout = m_timers.nextDeadline(MAX_WAIT_TIMEOUT);
+	for (auto& it : m_instances)
+		timeout = it->getTimeout(timeout);
+
+	if (m_replay != nullptr) {
+		if (m_fast)
 			return;
 
-		std::string action = json["action"];
-		if (action == "start" || action == "late_entry") {
-			if (!json.contains("slot") || !json.contains("destination_id") ||
-			    !json.contains("destination_type") || !json.contains("source"))
-				return;
-
-			int slot                     = json["slot"];
-			std::string source_info      = json.value("source_info", std::string());
-			int destination_id           = json["destination_id"];
-			std::string destination_type = json["destination_type"];
-			std::string source           = json["source"] == "rf" ? "R" : "N";
-
-			bool group = destination_type == "group";
-			m_display->writeDMR(slot, source_info, group, destination_id, source);
-		} else if (action == "end" || action == "lost") {
-			if (!json.contains("slot"))
-				return;
-			int slot = json["slot"];
-			m_display->clearDMR(slot);
-		}
+		unsigned int now = m_replayWatch.elapsed();
+		unsigned int due = m_replay->getTime() > now ? m_replay->getTime() - now : 0U;
+		if (due < timeout)
+			timeout = due;
 	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing DMR - %s", ex.what());
-	}
-}
-
-void CDisplayDriver::parseYSF(const nlohmann::json& json)
-{
-	assert(m_display != nullptr);
 
-	try {
-		if (!json.contains("action"))
-			return;
+	// The MQTT keepalive and reconnect handling needs regular servicing
+	if (timeout > MAX_WAIT_TIMEOUT)
+		timeout = MAX_WAIT_TIMEOUT;
 
-		std::string action = json["action"];
-		if (action == "start" || action == "late_entry") {
-			if (!json.contains("source_cs") || !json.contains("dg-id") ||
-			    !json.contains("source"))
-				return;
+	if (timeout == 0U)
+		return;
 
-			std::string source_cs = json["source_cs"];
-			int dgId              = json["dg-id"];
-			std::string reflector = json.value("reflector", std::string());
-			std::string source    = json["source"] == "rf" ? "R" : "N";
+	m_poller.reset();
 
-			m_display->writeFusion(source_cs, "ALL", dgId, source, reflector);
-		} else if (action == "end" || action == "lost") {
-			m_display->clearFusion();
-		}
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing YSF - %s", ex.what());
+	if (m_mqtt != nullptr) {
+		m_poller.add(m_mqtt->getSocket(), m_mqtt->wantWrite());
+		m_poller.add(m_mqtt->getWakeFD());
 	}
+
+	for (auto& it : m_instances)
+		it->addFDs(m_poller);
+
+	m_poller.wait(timeout);
 }
 
-void CDisplayDriver::parseP25(const nlohmann::json& json)
+bool CDisplayDriver::replay()
 {
-	assert(m_display != nullptr);
+	assert(m_replay != nullptr);
+
+	// When running flat out only one message is sent per pass of the main
+	// loop, so that the display is still clocked between them.
+	unsigned int now = m_replayWatch.elapsed();
+
+	while (m_fast || m_replay->getTime() <= now) {
+		const unsigned char* data = m_replay->getData();
+		unsigned int length       = m_replay->getLength();
+
+		unsigned int n = m_replay->getTopic() >> CAPTURE_INSTANCE_SHIFT;
+
+		if (length > 0U && n < m_instances.size()) {
+			switch (m_replay->getTopic() & CAPTURE_TOPIC_MASK) {
+				case CAPTURE_TOPIC_JSON:
+					onJSON(n, data, length);
+					break;
+				case CAPTURE_TOPIC_DISPLAY:
+					onDisplay(n, data, length);
+					break;
+				default:
+					break;
+			}
+		}
 
-	try {
-		if (!json.contains("action"))
-			return;
+		m_replayCount++;
 
-		std::string action = json["action"];
-		if (action == "start" || action == "late_entry") {
-			if (!json.contains("destination_id") || !json.contains("destination_type") ||
-			    !json.contains("source"))
-				return;
-
-			std::string source_info      = json.value("source_info", std::string());
-			int destination_id           = json["destination_id"];
-			std::string destination_type = json["destination_type"];
-			std::string source           = json["source"] == "rf" ? "R" : "N";
-
-			bool group = destination_type == "group";
-			m_display->writeP25(source_info, group, destination_id, source);
-		} else if (action == "end" || action == "lost") {
-			m_display->clearP25();
+		if (!m_replay->read()) {
+			LogInfo("Replayed %u messages in %u ms", m_replayCount, m_replayWatch.elapsed());
+			return false;
 		}
+
+		if (m_fast)
+			break;
 	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing P25 - %s", ex.what());
-	}
+
+	return true;
 }
 
-void CDisplayDriver::parseNXDN(const nlohmann::json& json)
+void CDisplayDriver::writeJSONMessage(const std::string& message)
 {
-	assert(m_display != nullptr);
+	nlohmann::json json;
 
-	try {
-		if (!json.contains("action"))
-			return;
+	json["timestamp"] = CUtils::createTimestamp();
+	json["message"]   = message;
 
-		std::string action = json["action"];
-		if (action == "start" || action == "late_entry") {
-			if (!json.contains("destination_id") || !json.contains("destination_type") ||
-			    !json.contains("source"))
-				return;
-
-			std::string source_info      = json.value("source_info", std::string());
-			int destination_id           = json["destination_id"];
-			std::string destination_type = json["destination_type"];
-			std::string source           = json["source"] == "rf" ? "R" : "N";
-
-			bool group = destination_type == "group";
-			m_display->writeNXDN(source_info, group, destination_id, source);
-		} else if (action == "end" || action == "lost") {
-			m_display->clearNXDN();
-		}
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing NXDN - %s", ex.what());
-	}
+	WriteJSON("status", json);
 }
 
-void CDisplayDriver::parsePOCSAG(const nlohmann::json& json)
+void CDisplayDriver::readDisplay(unsigned int n, const unsigned char* data, unsigned int length)
 {
-	assert(m_display != nullptr);
+	assert(data != nullptr);
+	assert(length > 0U);
 
-	try {
-		if (!json.contains("functional"))
-			return;
+	::MetricsCount(METRIC_COUNT::DISPLAY_MESSAGES);
 
-		std::string functional = json["functional"];
-		if (functional == "end") {
-			m_display->clearPOCSAG();
-		} else {
-			if (!json.contains("ric"))
-				return;
-			int ric             = json["ric"];
-			std::string message = json.value("message", std::string());
-			m_display->writePOCSAG(ric, message);
-		}
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing POCSAG - %s", ex.what());
-	}
+	if (m_capture != nullptr)
+		m_capture->write(CAPTURE_TOPIC_DISPLAY | (n << CAPTURE_INSTANCE_SHIFT), data, length);
+
+	m_instances.at(n)->readDisplay(data, length);
 }
 
-void CDisplayDriver::parseFM(const nlohmann::json& json)
+void CDisplayDriver::readJSON(unsigned int n, const char* text, unsigned int length)
 {
-	assert(m_display != nullptr);
+	assert(text != nullptr);
 
-	try {
-		if (!json.contains("state"))
-			return;
+	LogDebug("Incoming JSON - \"%.*s\"", int(length), text);
 
-		std::string state = json["state"];
-
-		if (state == "listening")
-			m_display->clearFM();
-		else if (state == "kerchunk_rf")
-			m_display->writeFM("R: Kerchunk");
-		else if (state == "relaying_rf")
-			m_display->writeFM("R: Relaying");
-		else if (state == "relaying_wait_rf" || state == "timeout_wait_rf" || state == "hang")
-			m_display->writeFM("R: Wait");
-		else if (state == "timeout_rf")
-			m_display->writeFM("R: Timeout");
-		else if (state == "kerchunk_ext")
-			m_display->writeFM("N: Kerchunk");
-		else if (state == "relaying_ext")
-			m_display->writeFM("N: Relaying");
-		else if (state == "relaying_wait_ext" || state == "timeout_wait_ext")
-			m_display->writeFM("N: Wait");
-		else if (state == "timeout_ext")
-			m_display->writeFM("N: Timeout");
-		else
-			m_display->writeFM(state);
-	}
-	catch (nlohmann::json::exception& ex) {
-		LogError("Error parsing FM - %s", ex.what());
-	}
+	::MetricsCount(METRIC_COUNT::JSON_MESSAGES);
+
+	if (m_capture != nullptr)
+		m_capture->write(CAPTURE_TOPIC_JSON | (n << CAPTURE_INSTANCE_SHIFT), (const unsigned char*)text, length);
+
+	m_instances.at(n)->readJSON(text, length);
 }
 
-void CDisplayDriver::onDisplay(const unsigned char* data, unsigned int length)
+void CDisplayDriver::onDisplay(unsigned int n, const unsigned char* data, unsigned int length)
 {
 	assert(data != nullptr);
 	assert(length > 0U);
-	assert(driver != nullptr);
 
-	driver->readDisplay(data, length);
+	readDisplay(n, data, length);
 }
 
-void CDisplayDriver::onJSON(const unsigned char* data, unsigned int length)
+void CDisplayDriver::onJSON(unsigned int n, const unsigned char* data, unsigned int length)
 {
 	assert(data != nullptr);
 	assert(length > 0U);
-	assert(driver != nullptr);
 
-	driver->readJSON(std::string((char*)data, length));
+	readJSON(n, (const char*)data, length);
 }
@@ -19,48 +19,53 @@
 #if !defined(DisplayDriver_H)
 #define	DisplayDriver_H
 
-#include "ModemSerialPort.h"
-#include "Display.h"
+#include "DisplayInstance.h"
+#include "TimerService.h"
+#include "StopWatch.h"
+#include "Capture.h"
+#include "Replay.h"
+#include "Poller.h"
 #include "Conf.h"
 
-#include <nlohmann/json.hpp>
-
 #include <string>
+#include <vector>
 
 class CDisplayDriver
 {
 public:
-	CDisplayDriver(const std::string& confFile);
+	CDisplayDriver(const std::string& confFile, const std::string& captureFile, const std::string& replayFile, bool fast);
 	~CDisplayDriver();
 
 	int run();
 
 private:
-	CConf             m_conf;
-	CDisplay*         m_display;
-	CModemSerialPort* m_msp;
+	std::string        m_confFile;
+	CConf              m_conf;
+	std::string        m_captureFile;
+	std::string        m_replayFile;
+	bool               m_fast;
+	std::vector<CDisplayInstance*> m_instances;
+	CCapture*          m_capture;
+	CReplay*           m_replay;
+	CStopWatch         m_replayWatch;
+	unsigned int       m_replayCount;
+	CPoller            m_poller;
+	CTimerService      m_timers;
 
-	bool createDisplay();
+	bool createInstances();
+	bool createMQTT();
 
-	void writeJSONMessage(const std::string& message);
+	void wait();
 
-	void readJSON(const std::string& text);
-	void readDisplay(const unsigned char* data, unsigned int length);
+	bool replay();
+
+	void writeJSONMessage(const std::string& message);
 
-	void parseMMDVM(const nlohmann::json& json);
-	void parseRSSI(const nlohmann::json& json);
-	void parseBER(const nlohmann::json& json);
-	void parseText(const nlohmann::json& json);
-	void parseDStar(const nlohmann::json& json);
-	void parseDMR(const nlohmann::json& json);
-	void parseYSF(const nlohmann::json& json);
-	void parseP25(const nlohmann::json& json);
-	void parseNXDN(const nlohmann::json& json);
-	void parsePOCSAG(const nlohmann::json& json);
-	void parseFM(const nlohmann::json& json);
+	void readJSON(unsigned int n, const char* text, unsigned int length);
+	void readDisplay(unsigned int n, const unsigned char* data, unsigned int length);
 
-	static void onDisplay(const unsigned char* data, unsigned int length);
-	static void onJSON(const unsigned char* data, unsigned int length);
+	void onDisplay(unsigned int n, const unsigned char* data, unsigned int length);
+	void onJSON(unsigned int n, const unsigned char* data, unsigned int length);
 };
 
 #endif
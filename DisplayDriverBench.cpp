@@ -0,0 +1,323 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "MessageParser.h"
+#include "DisplayEvent.h"
+#include "SerialPort.h"
+#include "RingBuffer.h"
+#include "TFTSurenoo.h"
+#include "Nextion.h"
+#include "Log.h"
+
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Count every heap allocation made while a benchmark runs
+static std::atomic<unsigned long long> m_allocations(0ULL);
+
+static void* allocate(size_t size)
+{
+	m_allocations++;
+
+	void* p = ::malloc(size == 0U ? 1U : size);
+	if (p == nullptr)
+		throw std::bad_alloc();
+
+	return p;
+}
+
+void* operator new(size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	::free(p);
+}
+
+// A serial port that goes nowhere, it can optionally answer every write
+// with a Nextion "instruction successful" reply, in order.
+class CNullSerialPort : public ISerialPort {
+public:
+	CNullSerialPort(bool ack) :
+	m_ack(ack),
+	m_replies(0U),
+	m_writes(0U),
+	m_bytes(0ULL)
+	{
+	}
+
+	virtual ~CNullSerialPort()
+	{
+	}
+
+	virtual bool open()
+	{
+		return true;
+	}
+
+	virtual int read(unsigned char* buffer, unsigned int length)
+	{
+		if (m_replies == 0U)
+			return 0;
+
+		static const unsigned char REPLY[] = {0x01U, 0xFFU, 0xFFU, 0xFFU};
+
+		unsigned int n = 0U;
+		while (n < length && m_replies > 0U) {
+			buffer[n++] = REPLY[(4U - (m_replies % 4U)) % 4U];
+			m_replies--;
+		}
+
+		return int(n);
+	}
+
+	virtual int readAvailable(unsigned char* buffer, unsigned int length)
+	{
+		return read(buffer, length);
+	}
+
+	virtual int write(const unsigned char* buffer, unsigned int length)
+	{
+		m_writes++;
+		m_bytes += length;
+
+		if (m_ack)
+			m_replies += 4U;
+
+		return int(length);
+	}
+
+	virtual void close()
+	{
+	}
+
+	bool               m_ack;
+	unsigned int       m_replies;
+	unsigned int       m_writes;
+	unsigned long long m_bytes;
+};
+
+// Runs the function in growing batches until it has taken long enough to
+// time reliably, then prints one JSON line with the results.
+template<class F> void runBench(const char* name, unsigned int bytesPerOp, F func)
+{
+	const unsigned long long MIN_TIME_NS = 200000000ULL;
+
+	unsigned long long iterations = 1ULL;
+
+	for (;;) {
+		unsigned long long allocations = m_allocations.load();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (unsigned long long i = 0ULL; i < iterations; i++)
+			func();
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		allocations = m_allocations.load() - allocations;
+
+		unsigned long long ns = (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+		if (ns >= MIN_TIME_NS || iterations >= 100000000ULL) {
+			double nsPerOp = double(ns) / double(iterations);
+			double opsPerSec = nsPerOp > 0.0 ? 1.0E9 / nsPerOp : 0.0;
+
+			::fprintf(stdout, "{\"name\":\"%s\",\"iterations\":%llu,\"ns_per_op\":%.1f,\"allocs_per_op\":%.3f,\"ops_per_sec\":%.0f,\"bytes_per_sec\":%.0f}\n",
+				name, iterations, nsPerOp, double(allocations) / double(iterations), opsPerSec, opsPerSec * double(bytesPerOp));
+			::fflush(stdout);
+			return;
+		}
+
+		iterations *= 2ULL;
+	}
+}
+
+static const char* MESSAGES[][2U] = {
+	{"parse/MMDVM",     "{\"MMDVM\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"mode\":\"idle\"}}"},
+	{"parse/RSSI",      "{\"RSSI\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"mode\":\"DMR\",\"slot\":2,\"value\":-73}}"},
+	{"parse/BER",       "{\"BER\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"mode\":\"DMR\",\"slot\":2,\"value\":0.4}}"},
+	{"parse/Text",      "{\"Text\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"mode\":\"DMR\",\"slot\":1,\"value\":\"G4KLX Jonathan\"}}"},
+	{"parse/D-Star",    "{\"D-Star\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"action\":\"start\",\"source_cs\":\"G4KLX\",\"source_ext\":\"ID51\",\"destination_cs\":\"CQCQCQ\",\"source\":\"network\",\"reflector\":\"REF001 C\"}}"},
+	{"parse/DMR",       "{\"DMR\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"action\":\"start\",\"slot\":2,\"source_id\":2341234,\"source_info\":\"G4KLX\",\"destination_id\":91,\"destination_type\":\"group\",\"source\":\"rf\"}}"},
+	{"parse/YSF",       "{\"YSF\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"action\":\"start\",\"source_cs\":\"G4KLX\",\"dg-id\":0,\"source\":\"rf\",\"reflector\":\"FCS00290\"}}"},
+	{"parse/P25",       "{\"P25\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"action\":\"start\",\"source_id\":1234,\"source_info\":\"G4KLX\",\"destination_id\":10200,\"destination_type\":\"group\",\"source\":\"rf\"}}"},
+	{"parse/NXDN",      "{\"NXDN\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"action\":\"start\",\"source_id\":1234,\"source_info\":\"G4KLX\",\"destination_id\":65000,\"destination_type\":\"group\",\"source\":\"rf\"}}"},
+	{"parse/POCSAG",    "{\"POCSAG\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"ric\":1234567,\"functional\":\"alphanumeric\",\"message\":\"This is a test message\"}}"},
+	{"parse/FM",        "{\"FM\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"state\":\"relaying_rf\"}}"},
+	{"parse/DMR-end",   "{\"DMR\":{\"timestamp\":\"2026-01-01 12:00:00.000\",\"action\":\"end\",\"slot\":2,\"duration\":3.2,\"loss\":0,\"ber\":0.1,\"rssi\":{\"min\":-80,\"max\":-70,\"ave\":-75}}}"}
+};
+
+static void benchParse()
+{
+	CMessageParser parser;
+
+	for (unsigned int i = 0U; i < (sizeof(MESSAGES) / sizeof(MESSAGES[0U])); i++) {
+		const char* text    = MESSAGES[i][1U];
+		unsigned int length = (unsigned int)::strlen(text);
+
+		// Only the parse, the display and the logging are left out
+		runBench(MESSAGES[i][0U], length, [&]() {
+			CDisplayEvent event;
+			parser.parse(text, length, event);
+		});
+	}
+}
+
+static void benchRingBuffer()
+{
+	static const unsigned int SIZES[] = {1U, 16U, 64U, 200U};
+
+	CRingBuffer<unsigned char> buffer(1000U, "Bench");
+
+	unsigned char data[200U];
+	::memset(data, 0x55U, 200U);
+
+	for (unsigned int i = 0U; i < (sizeof(SIZES) / sizeof(SIZES[0U])); i++) {
+		unsigned int size = SIZES[i];
+
+		char name[50U];
+		::sprintf(name, "RingBuffer/addget/%u", size);
+		runBench(name, size, [&]() {
+			buffer.addData(data, size);
+			buffer.getData(data, size);
+		});
+
+		buffer.addData(data, size);
+		::sprintf(name, "RingBuffer/peek/%u", size);
+		runBench(name, size, [&]() {
+			buffer.peek(data, size);
+		});
+
+		::sprintf(name, "RingBuffer/span/%u", size);
+		runBench(name, size, [&]() {
+			const unsigned char* span = nullptr;
+			buffer.span(span);
+		});
+		buffer.clear();
+	}
+}
+
+static void benchNextion()
+{
+	CNullSerialPort* serial = new CNullSerialPort(true);
+
+	CNextion nextion("G4KLX", 234567U, true, serial, 50U, false, false, 20U, 0U, false, 1U, 0U);
+	nextion.open();
+
+	// Queue the commands for a DMR call, then drain them through clock()
+	// with every command acknowledged at once. The destination and RSSI
+	// change every time, otherwise the display would already be showing
+	// them and most of the commands would be dropped as unchanged.
+	unsigned int n = 0U;
+	runBench("Nextion/sendCommand+drain", 0U, [&]() {
+		n++;
+		nextion.writeDMR(2U, "G4KLX", true, 91U + (n % 1000U), "R");
+		nextion.writeDMRRSSI(2U, -50 - int(n % 60U));
+		nextion.clearDMR(2U);
+
+		unsigned int writes;
+		do {
+			writes = serial->m_writes;
+			nextion.clock();
+		} while (serial->m_writes != writes);
+	});
+
+	nextion.close();
+}
+
+// The refresh is normally run by its timer, which is too slow to bench
+class CBenchTFTSurenoo : public CTFTSurenoo {
+public:
+	CBenchTFTSurenoo(ISerialPort* serial) :
+	CTFTSurenoo("G4KLX", 234567U, true, serial, 50U, 0U)
+	{
+	}
+
+	using CTFTSurenoo::refreshDisplay;
+};
+
+static void benchTFTSurenoo()
+{
+	CNullSerialPort* serial = new CNullSerialPort(false);
+
+	CBenchTFTSurenoo tft(serial);
+	tft.open();
+
+	// Every refresh includes the 5ms pause the panel needs
+	bool on = false;
+	runBench("TFTSurenoo/refreshDisplay", 0U, [&]() {
+		if (on)
+			tft.clearDMR(2U);
+		else
+			tft.writeDMR(2U, "G4KLX", true, 91U, "R");
+		on = !on;
+
+		tft.refreshDisplay();
+	});
+
+	tft.close();
+}
+
+static void benchLog()
+{
+	// Formatting happens even when the level is filtered out
+	runBench("Log/filtered", 0U, []() {
+		LogDebug("Nextion output - %s %u %d", "G4KLX", 91U, -73);
+	});
+}
+
+static bool isWanted(const char* filter, const char* group)
+{
+	return (filter == nullptr) || (::strstr(group, filter) != nullptr);
+}
+
+int main(int argc, char** argv)
+{
+	::LogInitialise(0U, 0U);
+
+	// An optional argument selects the benchmark groups to run
+	const char* filter = (argc > 1) ? argv[1] : nullptr;
+
+	if (isWanted(filter, "parse"))
+		benchParse();
+	if (isWanted(filter, "RingBuffer"))
+		benchRingBuffer();
+	if (isWanted(filter, "Nextion"))
+		benchNextion();
+	if (isWanted(filter, "TFTSurenoo"))
+		benchTFTSurenoo();
+	if (isWanted(filter, "Log"))
+		benchLog();
+
+	return 0;
+}
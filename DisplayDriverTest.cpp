@@ -0,0 +1,230 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "MultiDisplay.h"
+#include "MQTTConnection.h"
+#include "JSONParser.h"
+#include "Thread.h"
+#include "Dummy.h"
+#include "Log.h"
+
+#include <functional>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Counts what reaches it, and takes its time over each call
+class CSlowDisplay : public CDummy {
+public:
+	CSlowDisplay(unsigned int delay) :
+	CDummy(),
+	m_delay(delay),
+	m_idle(0U),
+	m_calls(0U),
+	m_rssi(0U),
+	m_last(DISPLAY_EVENT::SET_QUIT)
+	{
+	}
+
+	unsigned int               m_delay;
+	std::atomic<unsigned int>  m_idle;
+	std::atomic<unsigned int>  m_calls;
+	std::atomic<unsigned int>  m_rssi;
+	std::atomic<DISPLAY_EVENT> m_last;
+
+protected:
+	virtual void setIdleInt()
+	{
+		CThread::sleep(m_delay);
+		m_idle++;
+		m_last = DISPLAY_EVENT::SET_IDLE;
+	}
+
+	virtual void writeDMRInt(unsigned int slotNo, const std::string& src, bool group, unsigned int dst, const std::string& type)
+	{
+		CThread::sleep(m_delay);
+		m_calls++;
+		m_last = DISPLAY_EVENT::WRITE_DMR;
+	}
+
+	virtual void writeDMRRSSIInt(unsigned int slotNo, int rssi)
+	{
+		CThread::sleep(m_delay);
+		m_rssi++;
+		m_last = DISPLAY_EVENT::WRITE_DMR_RSSI;
+	}
+};
+
+static bool check(const char* name, bool ok)
+{
+	::fprintf(stdout, "%s: %s\n", ok ? "PASS" : "FAIL", name);
+
+	return ok;
+}
+
+// Drives the displays until the slow one has caught up, or gives up
+static void settle(CMultiDisplay& multi, const std::function<bool()>& done)
+{
+	for (unsigned int i = 0U; i < 500U; i++) {
+		multi.clock();
+
+		if (done())
+			break;
+
+		CThread::sleep(10U);
+	}
+}
+
+// Sends a burst of calls with their RSSI, far more than the queues hold
+static void burst(CMultiDisplay& multi, unsigned int calls)
+{
+	for (unsigned int i = 0U; i < calls; i++) {
+		multi.writeDMR(2U, "G4KLX", true, 91U + i, "R");
+
+		for (unsigned int j = 0U; j < 10U; j++)
+			multi.writeDMRRSSI(2U, -70 - int(j));
+	}
+}
+
+// A display that cannot keep up loses telemetry but no calls, and a fast
+// display loses nothing
+static bool testSlowDisplayCalls()
+{
+	const unsigned int CALLS = 20U;
+
+	CSlowDisplay* slow = new CSlowDisplay(5U);
+	CSlowDisplay* fast = new CSlowDisplay(0U);
+
+	CMultiDisplay multi(4U);
+	multi.add(slow, 0U);
+	multi.add(fast, 0U);
+
+	if (!multi.open())
+		return check("slow display opened", false);
+
+	burst(multi, CALLS);
+
+	settle(multi, [&]() { return slow->m_calls.load() == CALLS && fast->m_calls.load() == CALLS; });
+
+	multi.close();
+
+	bool ok = true;
+	ok &= check("slow display gets every call", slow->m_calls.load() == CALLS);
+	ok &= check("slow display drops telemetry", slow->m_rssi.load() < (CALLS * 10U));
+	ok &= check("fast display gets every call", fast->m_calls.load() == CALLS);
+
+	return ok;
+}
+
+// Going idle while a display is still far behind must not be lost
+static bool testSlowDisplayIdle()
+{
+	CSlowDisplay* slow = new CSlowDisplay(5U);
+
+	CMultiDisplay multi(4U);
+	multi.add(slow, 0U);
+
+	if (!multi.open())
+		return check("slow display opened", false);
+
+	burst(multi, 20U);
+
+	multi.setIdle();
+
+	settle(multi, [&]() { return slow->m_last.load() == DISPLAY_EVENT::SET_IDLE; });
+
+	bool ok = check("slow display ends up idle", slow->m_last.load() == DISPLAY_EVENT::SET_IDLE);
+
+	multi.close();
+
+	return ok;
+}
+
+// Keeps the last string value that was found
+class CStringHandler : public IJSONHandler {
+public:
+	std::string m_value;
+
+	virtual void onObjectStart(unsigned int depth, const char* key)
+	{
+	}
+
+	virtual void onObjectEnd(unsigned int depth)
+	{
+	}
+
+	virtual void onValue(unsigned int depth, const char* key, JSON_TYPE type, const char* value)
+	{
+		if (type == JSON_TYPE::STRING)
+			m_value = value;
+	}
+};
+
+static bool checkString(const char* name, const char* json, const char* expected)
+{
+	CJSONParser parser;
+	CStringHandler handler;
+
+	bool ret = parser.parse(json, (unsigned int)::strlen(json), handler);
+
+	return check(name, ret && handler.m_value == expected);
+}
+
+// Characters beyond the BMP are escaped as a surrogate pair, and must come
+// out as one four byte UTF-8 character
+static bool testJSONSurrogates()
+{
+	bool ok = true;
+	ok &= checkString("JSON surrogate pair", "{\"value\":\"a\\uD83D\\uDE00b\"}", "a\xF0\x9F\x98\x80" "b");
+	ok &= checkString("JSON unpaired high surrogate", "{\"value\":\"a\\uD83Db\"}", "a?b");
+	ok &= checkString("JSON high surrogate before a BMP escape", "{\"value\":\"\\uD83D\\u00E9\"}", "?\xC3\xA9");
+	ok &= checkString("JSON unpaired low surrogate", "{\"value\":\"\\uDE00\"}", "?");
+
+	return ok;
+}
+
+static bool testMQTTMatches()
+{
+	bool ok = true;
+	ok &= check("MQTT exact topic", CMQTTConnection::matches("a/b", "a/b"));
+	ok &= check("MQTT different topic", !CMQTTConnection::matches("a/b", "a/c"));
+	ok &= check("MQTT + matches one level", CMQTTConnection::matches("a/+/c", "a/b/c"));
+	ok &= check("MQTT + needs a level", !CMQTTConnection::matches("a/+", "a"));
+	ok &= check("MQTT # matches below", CMQTTConnection::matches("a/#", "a/b/c"));
+	ok &= check("MQTT # matches the parent", CMQTTConnection::matches("a/#", "a"));
+	ok &= check("MQTT # after + matches the parent", CMQTTConnection::matches("a/+/#", "a/b"));
+	ok &= check("MQTT # does not match a sibling", !CMQTTConnection::matches("a/#", "ab"));
+	ok &= check("MQTT short topic", !CMQTTConnection::matches("a/b/#", "a"));
+
+	return ok;
+}
+
+int main()
+{
+	::LogInitialise(0U, 0U);
+
+	bool ok = true;
+
+	ok &= testSlowDisplayCalls();
+	ok &= testSlowDisplayIdle();
+	ok &= testJSONSurrogates();
+	ok &= testMQTTMatches();
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,346 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DisplayEvent.h"
+#include "Display.h"
+
+#include <cassert>
+#include <cstring>
+
+static void copyText(char* dest, unsigned int length, const char* text)
+{
+	assert(dest != nullptr);
+	assert(text != nullptr);
+
+	::strncpy(dest, text, length - 1U);
+	dest[length - 1U] = '\0';
+}
+
+CDisplayEvent::CDisplayEvent(DISPLAY_EVENT event) :
+m_event(event),
+m_direct(false),
+m_slotNo(0U),
+m_group(false),
+m_number(0U),
+m_rssi(0),
+m_ber(0.0F)
+{
+	m_text1[0U] = '\0';
+	m_text2[0U] = '\0';
+	m_text3[0U] = '\0';
+	m_text4[0U] = '\0';
+	m_type[0U]  = '\0';
+}
+
+bool CDisplayEvent::isTelemetry() const
+{
+	switch (m_event) {
+		case DISPLAY_EVENT::WRITE_DSTAR_RSSI:
+		case DISPLAY_EVENT::WRITE_DSTAR_BER:
+		case DISPLAY_EVENT::WRITE_DSTAR_TEXT:
+		case DISPLAY_EVENT::WRITE_DMR_RSSI:
+		case DISPLAY_EVENT::WRITE_DMR_BER:
+		case DISPLAY_EVENT::WRITE_DMR_TA:
+		case DISPLAY_EVENT::WRITE_FUSION_RSSI:
+		case DISPLAY_EVENT::WRITE_FUSION_BER:
+		case DISPLAY_EVENT::WRITE_P25_RSSI:
+		case DISPLAY_EVENT::WRITE_P25_BER:
+		case DISPLAY_EVENT::WRITE_NXDN_RSSI:
+		case DISPLAY_EVENT::WRITE_NXDN_BER:
+		case DISPLAY_EVENT::WRITE_FM_RSSI:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool CDisplayEvent::isReset() const
+{
+	switch (m_event) {
+		case DISPLAY_EVENT::SET_IDLE:
+		case DISPLAY_EVENT::SET_LOCKOUT:
+		case DISPLAY_EVENT::SET_ERROR:
+		case DISPLAY_EVENT::SET_QUIT:
+			return true;
+		default:
+			return false;
+	}
+}
+
+void CDisplayEvent::setText1(const char* text)
+{
+	copyText(m_text1, DISPLAY_EVENT_TEXT_LENGTH, text);
+}
+
+void CDisplayEvent::setText2(const char* text)
+{
+	copyText(m_text2, DISPLAY_EVENT_FIELD_LENGTH, text);
+}
+
+void CDisplayEvent::setText3(const char* text)
+{
+	copyText(m_text3, DISPLAY_EVENT_FIELD_LENGTH, text);
+}
+
+void CDisplayEvent::setText4(const char* text)
+{
+	copyText(m_text4, DISPLAY_EVENT_FIELD_LENGTH, text);
+}
+
+void CDisplayEvent::setType(const char* type)
+{
+	copyText(m_type, DISPLAY_EVENT_FIELD_LENGTH, type);
+}
+
+void CDisplayEvent::apply(CDisplay* display) const
+{
+	assert(display != nullptr);
+
+	if (m_direct) {
+		applyInt(display);
+		return;
+	}
+
+	switch (m_event) {
+		case DISPLAY_EVENT::SET_IDLE:
+			display->setIdle();
+			break;
+		case DISPLAY_EVENT::SET_LOCKOUT:
+			display->setLockout();
+			break;
+		case DISPLAY_EVENT::SET_ERROR:
+			display->setError();
+			break;
+		case DISPLAY_EVENT::SET_QUIT:
+			display->setQuit();
+			break;
+
+		case DISPLAY_EVENT::WRITE_DSTAR:
+			display->writeDStar(m_text1, m_text2, m_text3, m_type, m_text4);
+			break;
+		case DISPLAY_EVENT::WRITE_DSTAR_RSSI:
+			display->writeDStarRSSI(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_DSTAR_BER:
+			display->writeDStarBER(m_ber);
+			break;
+		case DISPLAY_EVENT::WRITE_DSTAR_TEXT:
+			display->writeDStarText(m_text1);
+			break;
+		case DISPLAY_EVENT::CLEAR_DSTAR:
+			display->clearDStar();
+			break;
+
+		case DISPLAY_EVENT::WRITE_DMR:
+			display->writeDMR(m_slotNo, m_text1, m_group, m_number, m_type);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR_RSSI:
+			display->writeDMRRSSI(m_slotNo, m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR_BER:
+			display->writeDMRBER(m_slotNo, m_ber);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR_TA:
+			display->writeDMRTA(m_slotNo, m_text1);
+			break;
+		case DISPLAY_EVENT::CLEAR_DMR:
+			display->clearDMR(m_slotNo);
+			break;
+
+		case DISPLAY_EVENT::WRITE_FUSION:
+			display->writeFusion(m_text1, m_text2, (unsigned char)m_number, m_type, m_text4);
+			break;
+		case DISPLAY_EVENT::WRITE_FUSION_RSSI:
+			display->writeFusionRSSI(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_FUSION_BER:
+			display->writeFusionBER(m_ber);
+			break;
+		case DISPLAY_EVENT::CLEAR_FUSION:
+			display->clearFusion();
+			break;
+
+		case DISPLAY_EVENT::WRITE_P25:
+			display->writeP25(m_text1, m_group, m_number, m_type);
+			break;
+		case DISPLAY_EVENT::WRITE_P25_RSSI:
+			display->writeP25RSSI(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_P25_BER:
+			display->writeP25BER(m_ber);
+			break;
+		case DISPLAY_EVENT::CLEAR_P25:
+			display->clearP25();
+			break;
+
+		case DISPLAY_EVENT::WRITE_NXDN:
+			display->writeNXDN(m_text1, m_group, m_number, m_type);
+			break;
+		case DISPLAY_EVENT::WRITE_NXDN_RSSI:
+			display->writeNXDNRSSI(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_NXDN_BER:
+			display->writeNXDNBER(m_ber);
+			break;
+		case DISPLAY_EVENT::CLEAR_NXDN:
+			display->clearNXDN();
+			break;
+
+		case DISPLAY_EVENT::WRITE_POCSAG:
+			display->writePOCSAG(m_number, m_text1);
+			break;
+		case DISPLAY_EVENT::CLEAR_POCSAG:
+			display->clearPOCSAG();
+			break;
+
+		case DISPLAY_EVENT::WRITE_FM:
+			display->writeFM(m_text1);
+			break;
+		case DISPLAY_EVENT::WRITE_FM_RSSI:
+			display->writeFMRSSI(m_rssi);
+			break;
+		case DISPLAY_EVENT::CLEAR_FM:
+			display->clearFM();
+			break;
+
+		case DISPLAY_EVENT::WRITE_CW:
+			display->writeCW();
+			break;
+
+		default:
+			break;
+	}
+}
+
+void CDisplayEvent::applyInt(CDisplay* display) const
+{
+	assert(display != nullptr);
+
+	switch (m_event) {
+		case DISPLAY_EVENT::SET_IDLE:
+			display->setIdleInt();
+			break;
+		case DISPLAY_EVENT::SET_LOCKOUT:
+			display->setLockoutInt();
+			break;
+		case DISPLAY_EVENT::SET_ERROR:
+			display->setErrorInt();
+			break;
+		case DISPLAY_EVENT::SET_QUIT:
+			display->setQuitInt();
+			break;
+
+		case DISPLAY_EVENT::WRITE_DSTAR:
+			display->writeDStarInt(m_text1, m_text2, m_text3, m_type, m_text4);
+			break;
+		case DISPLAY_EVENT::WRITE_DSTAR_RSSI:
+			display->writeDStarRSSIInt(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_DSTAR_BER:
+			display->writeDStarBERInt(m_ber);
+			break;
+		case DISPLAY_EVENT::WRITE_DSTAR_TEXT:
+			display->writeDStarTextInt(m_text1);
+			break;
+		case DISPLAY_EVENT::CLEAR_DSTAR:
+			display->clearDStarInt();
+			break;
+
+		case DISPLAY_EVENT::WRITE_DMR:
+			display->writeDMRInt(m_slotNo, m_text1, m_group, m_number, m_type);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR_RSSI:
+			display->writeDMRRSSIInt(m_slotNo, m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR_BER:
+			display->writeDMRBERInt(m_slotNo, m_ber);
+			break;
+		case DISPLAY_EVENT::WRITE_DMR_TA:
+			display->writeDMRTAInt(m_slotNo, m_text1);
+			break;
+		case DISPLAY_EVENT::CLEAR_DMR:
+			display->clearDMRInt(m_slotNo);
+			break;
+
+		case DISPLAY_EVENT::WRITE_FUSION:
+			display->writeFusionInt(m_text1, m_text2, (unsigned char)m_number, m_type, m_text4);
+			break;
+		case DISPLAY_EVENT::WRITE_FUSION_RSSI:
+			display->writeFusionRSSIInt(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_FUSION_BER:
+			display->writeFusionBERInt(m_ber);
+			break;
+		case DISPLAY_EVENT::CLEAR_FUSION:
+			display->clearFusionInt();
+			break;
+
+		case DISPLAY_EVENT::WRITE_P25:
+			display->writeP25Int(m_text1, m_group, m_number, m_type);
+			break;
+		case DISPLAY_EVENT::WRITE_P25_RSSI:
+			display->writeP25RSSIInt(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_P25_BER:
+			display->writeP25BERInt(m_ber);
+			break;
+		case DISPLAY_EVENT::CLEAR_P25:
+			display->clearP25Int();
+			break;
+
+		case DISPLAY_EVENT::WRITE_NXDN:
+			display->writeNXDNInt(m_text1, m_group, m_number, m_type);
+			break;
+		case DISPLAY_EVENT::WRITE_NXDN_RSSI:
+			display->writeNXDNRSSIInt(m_rssi);
+			break;
+		case DISPLAY_EVENT::WRITE_NXDN_BER:
+			display->writeNXDNBERInt(m_ber);
+			break;
+		case DISPLAY_EVENT::CLEAR_NXDN:
+			display->clearNXDNInt();
+			break;
+
+		case DISPLAY_EVENT::WRITE_POCSAG:
+			display->writePOCSAGInt(m_number, m_text1);
+			break;
+		case DISPLAY_EVENT::CLEAR_POCSAG:
+			display->clearPOCSAGInt();
+			break;
+
+		case DISPLAY_EVENT::WRITE_FM:
+			display->writeFMInt(m_text1);
+			break;
+		case DISPLAY_EVENT::WRITE_FM_RSSI:
+			display->writeFMRSSIInt(m_rssi);
+			break;
+		case DISPLAY_EVENT::CLEAR_FM:
+			display->clearFMInt();
+			break;
+
+		case DISPLAY_EVENT::WRITE_CW:
+			display->writeCWInt();
+			break;
+		case DISPLAY_EVENT::CLEAR_CW:
+			display->clearCWInt();
+			break;
+
+		default:
+			break;
+	}
+}
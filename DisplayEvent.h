@@ -0,0 +1,108 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DISPLAYEVENT_H)
+#define	DISPLAYEVENT_H
+
+class CDisplay;
+
+enum class DISPLAY_EVENT : unsigned char {
+	SET_IDLE,
+	SET_LOCKOUT,
+	SET_ERROR,
+	SET_QUIT,
+
+	WRITE_DSTAR,
+	WRITE_DSTAR_RSSI,
+	WRITE_DSTAR_BER,
+	WRITE_DSTAR_TEXT,
+	CLEAR_DSTAR,
+
+	WRITE_DMR,
+	WRITE_DMR_RSSI,
+	WRITE_DMR_BER,
+	WRITE_DMR_TA,
+	CLEAR_DMR,
+
+	WRITE_FUSION,
+	WRITE_FUSION_RSSI,
+	WRITE_FUSION_BER,
+	CLEAR_FUSION,
+
+	WRITE_P25,
+	WRITE_P25_RSSI,
+	WRITE_P25_BER,
+	CLEAR_P25,
+
+	WRITE_NXDN,
+	WRITE_NXDN_RSSI,
+	WRITE_NXDN_BER,
+	CLEAR_NXDN,
+
+	WRITE_POCSAG,
+	CLEAR_POCSAG,
+
+	WRITE_FM,
+	WRITE_FM_RSSI,
+	CLEAR_FM,
+
+	WRITE_CW,
+	CLEAR_CW
+};
+
+const unsigned int DISPLAY_EVENT_TEXT_LENGTH  = 200U;
+const unsigned int DISPLAY_EVENT_FIELD_LENGTH = 20U;
+
+// A fixed size record of one call into CDisplay, so that display updates
+// can be queued and copied between threads without any allocations.
+class CDisplayEvent {
+public:
+	CDisplayEvent(DISPLAY_EVENT event = DISPLAY_EVENT::SET_IDLE);
+
+	void setText1(const char* text);
+	void setText2(const char* text);
+	void setText3(const char* text);
+	void setText4(const char* text);
+	void setType(const char* type);
+
+	// RSSI, BER and text updates, the next one replaces what was lost
+	bool isTelemetry() const;
+
+	// Idle, lockout, error and quit, which make anything before them stale
+	bool isReset() const;
+
+	void apply(CDisplay* display) const;
+
+	DISPLAY_EVENT m_event;
+	bool          m_direct;		// Skips the hold timers in CDisplay, they have already run
+	unsigned int  m_slotNo;
+	bool          m_group;
+	unsigned int  m_number;		// Destination id, DG-ID or RIC
+	int           m_rssi;
+	float         m_ber;
+	char          m_text1[DISPLAY_EVENT_TEXT_LENGTH];	// Source, talker alias, message or state
+	char          m_text2[DISPLAY_EVENT_FIELD_LENGTH];	// D-Star suffix or YSF destination
+	char          m_text3[DISPLAY_EVENT_FIELD_LENGTH];	// D-Star your callsign
+	char          m_text4[DISPLAY_EVENT_FIELD_LENGTH];	// Reflector or origin
+	char          m_type[DISPLAY_EVENT_FIELD_LENGTH];	// "R" or "N"
+
+private:
+	void applyInt(CDisplay* display) const;
+};
+
+#endif
@@ -0,0 +1,449 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "DisplayInstance.h"
+#include "UARTController.h"
+#include "MultiDisplay.h"
+#include "TFTSurenoo.h"
+#include "LCDproc.h"
+#include "Metrics.h"
+#include "Nextion.h"
+#include "Dummy.h"
+#include "Log.h"
+
+#if defined(USE_HD44780)
+#include "HD44780.h"
+#endif
+
+#if defined(USE_OLED)
+#include "OLED.h"
+#endif
+
+#include <cassert>
+#include <cstring>
+
+// The number of display events that can be waiting for the display thread
+const unsigned int DISPLAY_QUEUE_LENGTH = 100U;
+
+CDisplayInstance::CDisplayInstance(const CConf& conf, const std::string& name, CTimerService& timers) :
+m_conf(conf),
+m_name(name),
+m_timers(timers),
+m_display(nullptr),
+m_msp(nullptr),
+m_thread(nullptr),
+m_coalescer(nullptr),
+m_parser()
+{
+}
+
+CDisplayInstance::~CDisplayInstance()
+{
+	delete m_coalescer;
+	delete m_display;
+}
+
+bool CDisplayInstance::open()
+{
+	bool ret = createDisplay();
+	if (!ret)
+		return false;
+
+	if (m_conf.getDisplayThread()) {
+		m_thread = new CDisplayThread(m_display, DISPLAY_QUEUE_LENGTH);
+
+		ret = m_thread->start();
+		if (!ret) {
+			LogError("Unable to start the display thread");
+			delete m_thread;
+			m_thread = nullptr;
+
+			m_display->close();
+			delete m_display;
+			m_display = nullptr;
+			m_msp     = nullptr;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::string CDisplayInstance::getMMDVMName() const
+{
+	return m_conf.getMMDVMName();
+}
+
+void CDisplayInstance::readJSON(const char* text, unsigned int length)
+{
+	assert(text != nullptr);
+
+	unsigned long long start = ::MetricsNow();
+
+	CDisplayEvent event;
+	bool ret = m_parser.parse(text, length, event);
+
+	::MetricsTime(METRIC_TIME::PARSE, ::MetricsNow() - start);
+
+	if (ret)
+		writeEvent(event);
+}
+
+void CDisplayInstance::readDisplay(const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+	assert(length > 0U);
+
+	if (m_msp != nullptr)
+		m_msp->readData(data, length);
+}
+
+void CDisplayInstance::clock()
+{
+	assert(m_display != nullptr);
+
+	// The display thread clocks the display itself
+	if (m_thread == nullptr)
+		m_display->clock();
+	else
+		m_thread->flush();
+
+	if (m_coalescer != nullptr) {
+		CDisplayEvent event;
+		while (m_coalescer->get(event))
+			sendEvent(event);
+	}
+}
+
+unsigned int CDisplayInstance::getTimeout(unsigned int timeout)
+{
+	assert(m_display != nullptr);
+
+	if (m_thread == nullptr) {
+		unsigned int due = m_display->getTimeout();
+		if (due < timeout)
+			timeout = due;
+	} else if (m_thread->hasBacklog() && BACKLOG_RETRY < timeout) {
+		timeout = BACKLOG_RETRY;
+	}
+
+	return timeout;
+}
+
+void CDisplayInstance::addFDs(CPoller& poller)
+{
+	assert(m_display != nullptr);
+
+	// When the display has its own thread its port is not ours to wait on
+	if (m_thread == nullptr)
+		poller.add(m_display->getFD(), m_display->wantWrite());
+}
+
+void CDisplayInstance::close()
+{
+	if (m_thread != nullptr) {
+		m_thread->stop();
+		delete m_thread;
+		m_thread = nullptr;
+	}
+
+	delete m_coalescer;
+	m_coalescer = nullptr;
+
+	if (m_display != nullptr) {
+		m_display->close();
+		delete m_display;
+		m_display = nullptr;
+		m_msp     = nullptr;
+	}
+}
+
+bool CDisplayInstance::createDisplay()
+{
+	LogInfo("Display Parameters");
+	if (!m_name.empty())
+		LogInfo("    Instance: %s", m_name.c_str());
+	LogInfo("    MMDVM Name: %s", m_conf.getMMDVMName().c_str());
+	LogInfo("    Display Thread: %s", m_conf.getDisplayThread() ? "yes" : "no");
+
+	std::vector<std::string> types;
+
+	std::string list = m_conf.getDisplay();
+	char* p = ::strtok(&list[0U], ", \t");
+	while (p != nullptr) {
+		types.push_back(p);
+		p = ::strtok(nullptr, ", \t");
+	}
+
+	if (types.empty()) {
+		LogError("No valid display found");
+		return false;
+	}
+
+	if (types.size() == 1U) {
+		unsigned int telemetryInterval = 0U;
+		m_display = createDisplay(types.front(), telemetryInterval);
+		if (m_display == nullptr)
+			return false;
+
+		if (telemetryInterval > 0U) {
+			LogInfo("    Telemetry Interval: %ums", telemetryInterval);
+			m_coalescer = new CDisplayCoalescer(m_timers, telemetryInterval);
+		}
+	} else {
+		// Each display gets its own thread and its own telemetry interval
+		CMultiDisplay* multi = new CMultiDisplay(DISPLAY_QUEUE_LENGTH);
+
+		for (const auto& type : types) {
+			unsigned int telemetryInterval = 0U;
+			CDisplay* display = createDisplay(type, telemetryInterval);
+			if (display == nullptr) {
+				delete multi;
+				m_msp = nullptr;
+				return false;
+			}
+
+			if (telemetryInterval > 0U)
+				LogInfo("    Telemetry Interval: %ums", telemetryInterval);
+
+			multi->add(display, telemetryInterval);
+		}
+
+		m_display = multi;
+	}
+
+	bool ret = m_display->open();
+	if (!ret) {
+		delete m_coalescer;
+		m_coalescer = nullptr;
+
+		delete m_display;
+		m_display = nullptr;
+		m_msp     = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+// The modem has a single display port, and the replies from it can only
+// go back to one display
+CModemSerialPort* CDisplayInstance::createModemPort()
+{
+	if (m_msp != nullptr) {
+		LogError("Only one display can use the modem port");
+		return nullptr;
+	}
+
+	m_msp = new CModemSerialPort(m_conf.getMMDVMName());
+
+	return m_msp;
+}
+
+CDisplay* CDisplayInstance::createDisplay(const std::string& type, unsigned int& telemetryInterval)
+{
+	CDisplay* display = nullptr;
+
+	LogInfo("    Type: %s", type.c_str());
+
+	if (type == "TFTSurenoo") {
+		std::string port          = m_conf.getTFTSurenooPort();
+		unsigned int brightness   = m_conf.getTFTSurenooBrightness();
+		unsigned int screenLayout = m_conf.getTFTSurenooScreenLayout();
+		bool lowLatency           = m_conf.getTFTSurenooLowLatency();
+
+		LogInfo("    Port: %s", port.c_str());
+		LogInfo("    Brightness: %u", brightness);
+		LogInfo("    Screen Layout: %u", screenLayout);
+		LogInfo("    Low Latency: %s", lowLatency ? "yes" : "no");
+
+		telemetryInterval = m_conf.getTFTSurenooTelemetryInterval();
+
+		ISerialPort* serial = nullptr;
+		if (port == "modem") {
+			serial = createModemPort();
+			if (serial == nullptr)
+				return nullptr;
+		} else {
+			serial = new CUARTController(port, 115200U, false, lowLatency);
+		}
+
+		display = new CTFTSurenoo(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), serial, brightness, screenLayout);
+	} else if (type == "Nextion") {
+		std::string port            = m_conf.getNextionPort();
+		unsigned int brightness     = m_conf.getNextionBrightness();
+		bool displayClock           = m_conf.getNextionDisplayClock();
+		bool utc                    = m_conf.getNextionUTC();
+		unsigned int idleBrightness = m_conf.getNextionIdleBrightness();
+		unsigned int screenLayout   = m_conf.getNextionScreenLayout();
+		bool displayTempInF         = m_conf.getNextionTempInFahrenheit();
+		unsigned int window         = m_conf.getNextionWindow();
+		unsigned int maxBaudrate    = m_conf.getNextionBaudrate();
+		bool lowLatency             = m_conf.getNextionLowLatency();
+
+		LogInfo("    Port: %s", port.c_str());
+		LogInfo("    Brightness: %u", brightness);
+		LogInfo("    Clock Display: %s", displayClock ? "yes" : "no");
+		if (displayClock)
+			LogInfo("    Display UTC: %s", utc ? "yes" : "no");
+		LogInfo("    Idle Brightness: %u", idleBrightness);
+		LogInfo("    Temperature in Fahrenheit: %s ", displayTempInF ? "yes" : "no");
+		LogInfo("    Command Window: %u", window);
+		if (maxBaudrate > 0U)
+			LogInfo("    Raised Baudrate: %u", maxBaudrate);
+		LogInfo("    Low Latency: %s", lowLatency ? "yes" : "no");
+
+		telemetryInterval = m_conf.getNextionTelemetryInterval();
+ 
+		switch (screenLayout) {
+		case 0U:
+			LogInfo("    Screen Layout: G4KLX (Default)");
+			break;
+		case 2U:
+			LogInfo("    Screen Layout: ON7LDS");
+			break;
+		case 3U:
+			LogInfo("    Screen Layout: DIY by ON7LDS");
+			break;
+		case 4U:
+			LogInfo("    Screen Layout: DIY by ON7LDS (High speed)");
+			break;
+		default:
+			LogInfo("    Screen Layout: %u (Unknown)", screenLayout);
+			break;
+		}
+
+		if (port == "modem") {
+			ISerialPort* serial = createModemPort();
+			if (serial == nullptr)
+				return nullptr;
+
+			display = new CNextion(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), serial, brightness, displayClock, utc, idleBrightness, screenLayout, displayTempInF, window, maxBaudrate);
+		} else {
+			unsigned int baudrate = 9600U;
+			if (screenLayout == 4U)
+				baudrate = 115200U;
+			
+			LogInfo("    Display baudrate: %u ", baudrate);
+			ISerialPort* serial = new CUARTController(port, baudrate, false, lowLatency);
+			display = new CNextion(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), serial, brightness, displayClock, utc, idleBrightness, screenLayout, displayTempInF, window, maxBaudrate);
+		}
+	} else if (type == "LCDproc") {
+		std::string address       = m_conf.getLCDprocAddress();
+		unsigned int port         = m_conf.getLCDprocPort();
+		unsigned int localPort    = m_conf.getLCDprocLocalPort();
+		bool displayClock         = m_conf.getLCDprocDisplayClock();
+		bool utc                  = m_conf.getLCDprocUTC();
+		bool dimOnIdle            = m_conf.getLCDprocDimOnIdle();
+
+		LogInfo("    Address: %s", address.c_str());
+		LogInfo("    Port: %u", port);
+
+		if (localPort == 0U)
+			LogInfo("    Local Port: random");
+		else
+			LogInfo("    Local Port: %u", localPort);
+
+		LogInfo("    Dim Display on Idle: %s", dimOnIdle ? "yes" : "no");
+		LogInfo("    Clock Display: %s", displayClock ? "yes" : "no");
+
+		if (displayClock)
+			LogInfo("    Display UTC: %s", utc ? "yes" : "no");
+
+		telemetryInterval = m_conf.getLCDprocTelemetryInterval();
+
+		display = new CLCDproc(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), address, port, localPort, displayClock, utc, dimOnIdle);
+#if defined(USE_HD44780)
+	} else if (type == "HD44780") {
+		unsigned int rows              = m_conf.getHD44780Rows();
+		unsigned int columns           = m_conf.getHD44780Columns();
+		std::vector<unsigned int> pins = m_conf.getHD44780Pins();
+		unsigned int i2cAddress        = m_conf.getHD44780i2cAddress();
+		bool pwm                       = m_conf.getHD44780PWM();
+		unsigned int pwmPin            = m_conf.getHD44780PWMPin();
+		unsigned int pwmBright         = m_conf.getHD44780PWMBright();
+		unsigned int pwmDim            = m_conf.getHD44780PWMDim();
+		bool displayClock              = m_conf.getHD44780DisplayClock();
+		bool utc                       = m_conf.getHD44780UTC();
+
+		if (pins.size() == 6U) {
+			LogInfo("    Rows: %u", rows);
+			LogInfo("    Columns: %u", columns);
+
+#if defined(USE_ADAFRUIT_DISPLAY) || defined(USE_PCF8574_DISPLAY)
+			LogInfo("    Device Address: %#x", i2cAddress);
+#else
+			LogInfo("    Pins: %u,%u,%u,%u,%u,%u", pins.at(0U), pins.at(1U), pins.at(2U), pins.at(3U), pins.at(4U), pins.at(5U));
+#endif
+
+			LogInfo("    PWM Backlight: %s", pwm ? "yes" : "no");
+			if (pwm) {
+				LogInfo("    PWM Pin: %u", pwmPin);
+				LogInfo("    PWM Bright: %u", pwmBright);
+				LogInfo("    PWM Dim: %u", pwmDim);
+			}
+
+			LogInfo("    Clock Display: %s", displayClock ? "yes" : "no");
+			if (displayClock)
+				LogInfo("    Display UTC: %s", utc ? "yes" : "no");
+
+			telemetryInterval = m_conf.getHD44780TelemetryInterval();
+
+			display = new CHD44780(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), rows, columns, pins, i2cAddress, pwm, pwmPin, pwmBright, pwmDim, displayClock, utc);
+		}
+#endif
+#if defined(USE_OLED)
+	} else if (type == "OLED") {
+		unsigned char type       = m_conf.getOLEDType();
+		unsigned char brightness = m_conf.getOLEDBrightness();
+		bool          invert     = m_conf.getOLEDInvert();
+		bool          scroll     = m_conf.getOLEDScroll();
+		bool          rotate     = m_conf.getOLEDRotate();
+		bool          logosaver  = m_conf.getOLEDLogoScreensaver();
+
+		telemetryInterval = m_conf.getOLEDTelemetryInterval();
+
+		display = new COLED(m_conf.getCallsign(), m_conf.getId(), m_conf.getDuplex(), type, brightness, invert, scroll, rotate, logosaver);
+#endif
+	} else if (type == "Dummy") {
+		display = new CDummy;
+	} else {
+		LogError("No valid display found - %s", type.c_str());
+		return nullptr;
+	}
+
+
+	return display;
+}
+
+void CDisplayInstance::writeEvent(const CDisplayEvent& event)
+{
+	if (m_coalescer != nullptr && m_coalescer->add(event))
+		return;
+
+	sendEvent(event);
+}
+
+void CDisplayInstance::sendEvent(const CDisplayEvent& event)
+{
+	if (m_thread != nullptr)
+		m_thread->post(event);
+	else
+		event.apply(m_display);
+}
@@ -0,0 +1,78 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#if !defined(DISPLAYINSTANCE_H)
+#define	DISPLAYINSTANCE_H
+
+#include "DisplayCoalescer.h"
+#include "ModemSerialPort.h"
+#include "TimerService.h"
+#include "DisplayThread.h"
+#include "MessageParser.h"
+#include "DisplayEvent.h"
+#include "Display.h"
+#include "Poller.h"
+#include "Conf.h"
+
+#include <string>
+
+// One MMDVMHost instance and the display showing it, with everything the
+// display needs between the MQTT messages and the panel.
+class CDisplayInstance
+{
+public:
+	// The timers are those of the thread that calls clock()
+	CDisplayInstance(const CConf& conf, const std::string& name, CTimerService& timers);
+	~CDisplayInstance();
+
+	bool open();
+
+	std::string getMMDVMName() const;
+
+	void readJSON(const char* text, unsigned int length);
+	void readDisplay(const unsigned char* data, unsigned int length);
+
+	void clock();
+
+	// Lowers the timeout to when this instance next has work to do
+	unsigned int getTimeout(unsigned int timeout);
+
+	void addFDs(CPoller& poller);
+
+	void close();
+
+private:
+	CConf              m_conf;
+	std::string        m_name;
+	CTimerService&     m_timers;
+	CDisplay*          m_display;
+	CModemSerialPort*  m_msp;
+	CDisplayThread*    m_thread;
+	CDisplayCoalescer* m_coalescer;
+	CMessageParser     m_parser;
+
+	bool createDisplay();
+	CDisplay* createDisplay(const std::string& type, unsigned int& telemetryInterval);
+	CModemSerialPort* createModemPort();
+
+	void writeEvent(const CDisplayEvent& event);
+	void sendEvent(const CDisplayEvent& event);
+};
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "DisplayThread.h"
+#include "Log.h"
+
+#include <cassert>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+// The longest the render thread will sleep for when nothing is happening
+const unsigned int MAX_DISPLAY_WAIT = 1000U;
+
+CDisplayThread::CDisplayThread(CDisplay* display, unsigned int length) :
+CThread(),
+m_display(display),
+m_queue(length),
+m_poller(),
+m_stopped(false),
+m_dropped(0U),
+m_backlog()
+{
+	assert(display != nullptr);
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	m_pipe[0U] = -1;
+	m_pipe[1U] = -1;
+#endif
+}
+
+CDisplayThread::~CDisplayThread()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_pipe[0U] != -1)
+		::close(m_pipe[0U]);
+	if (m_pipe[1U] != -1)
+		::close(m_pipe[1U]);
+#endif
+}
+
+bool CDisplayThread::start()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	// The pipe lets the MQTT thread interrupt the poll() in the render thread
+	if (::pipe(m_pipe) == -1) {
+		LogError("Cannot create the display thread pipe, errno=%d", errno);
+		return false;
+	}
+
+	for (unsigned int i = 0U; i < 2U; i++) {
+		int flags = ::fcntl(m_pipe[i], F_GETFL, 0);
+		::fcntl(m_pipe[i], F_SETFL, flags | O_NONBLOCK);
+	}
+#endif
+
+	return run();
+}
+
+bool CDisplayThread::post(const CDisplayEvent& event)
+{
+	// Anything held back goes first, so that the order is kept
+	flush();
+
+	if (m_backlog.empty() && m_queue.put(event)) {
+		if (m_dropped > 0U) {
+			LogWarning("Display event queue has recovered, %u telemetry events dropped", m_dropped);
+			m_dropped = 0U;
+		}
+
+		wakeup();
+		return true;
+	}
+
+	if (event.isTelemetry()) {
+		// Only log the first of a run of drops, the panel is already behind
+		if (m_dropped++ == 0U)
+			LogWarning("Display event queue is full, dropping telemetry");
+		return false;
+	}
+
+	// A change of state must reach the display however far behind it is,
+	// but a reset makes everything still waiting for it stale
+	if (event.isReset())
+		m_backlog.clear();
+
+	m_backlog.push_back(event);
+
+	return true;
+}
+
+void CDisplayThread::flush()
+{
+	if (m_backlog.empty())
+		return;
+
+	while (!m_backlog.empty() && m_queue.put(m_backlog.front()))
+		m_backlog.pop_front();
+
+	wakeup();
+}
+
+bool CDisplayThread::hasBacklog() const
+{
+	return !m_backlog.empty();
+}
+
+void CDisplayThread::stop()
+{
+	// The display thread is still running, so it will make room
+	while (!m_backlog.empty()) {
+		flush();
+
+		if (!m_backlog.empty())
+			CThread::sleep(BACKLOG_RETRY);
+	}
+
+	m_stopped.store(true);
+
+	wakeup();
+
+	wait();
+}
+
+void CDisplayThread::wakeup()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	// A full pipe already guarantees a wake up, so the result doesn't matter
+	unsigned char c = 0x00U;
+	ssize_t n = ::write(m_pipe[1U], &c, 1U);
+	(void)n;
+#endif
+}
+
+void CDisplayThread::drain()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	unsigned char buffer[16U];
+	while (::read(m_pipe[0U], buffer, 16U) > 0)
+		;
+#endif
+}
+
+void CDisplayThread::entry()
+{
+	LogInfo("Started the display thread");
+
+	while (!m_stopped.load()) {
+		CDisplayEvent event;
+		while (m_queue.get(event))
+			event.apply(m_display);
+
+		m_display->clock();
+
+		unsigned int timeout = m_display->getTimeout();
+		if (timeout > MAX_DISPLAY_WAIT)
+			timeout = MAX_DISPLAY_WAIT;
+
+		if (timeout == 0U || !m_queue.isEmpty())
+			continue;
+
+		m_poller.reset();
+#if !defined(_WIN32) && !defined(_WIN64)
+		m_poller.add(m_pipe[0U]);
+#endif
+		m_poller.add(m_display->getFD(), m_display->wantWrite());
+
+		m_poller.wait(timeout);
+
+		drain();
+	}
+
+	// Anything posted before stop(), such as the final quit screen, still
+	// has to reach the display before it is closed
+	CDisplayEvent event;
+	while (m_queue.get(event))
+		event.apply(m_display);
+
+	m_display->clock();
+
+	LogInfo("Stopped the display thread");
+}
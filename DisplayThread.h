@@ -0,0 +1,71 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(DISPLAYTHREAD_H)
+#define	DISPLAYTHREAD_H
+
+#include "DisplayEvent.h"
+#include "EventQueue.h"
+#include "Display.h"
+#include "Poller.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <deque>
+
+// How often, in ms, the events held back for a full queue are tried again
+const unsigned int BACKLOG_RETRY = 20U;
+
+// Owns the display and drives it from its own thread, so that a slow panel
+// never holds up the MQTT connection. Events arrive from the MQTT thread.
+class CDisplayThread : public CThread {
+public:
+	CDisplayThread(CDisplay* display, unsigned int length);
+	virtual ~CDisplayThread();
+
+	bool start();
+
+	// Called from the MQTT thread only. When the queue is full telemetry is
+	// dropped, and anything else is held back until there is room for it.
+	bool post(const CDisplayEvent& event);
+
+	// Moves what has been held back into the queue, as far as it will go
+	void flush();
+
+	bool hasBacklog() const;
+
+	void stop();
+
+	virtual void entry();
+
+private:
+	CDisplay*                   m_display;
+	CEventQueue<CDisplayEvent>  m_queue;
+	CPoller                     m_poller;
+	std::atomic<bool>           m_stopped;
+	unsigned int                m_dropped;
+	std::deque<CDisplayEvent>   m_backlog;
+#if !defined(_WIN32) && !defined(_WIN64)
+	int                         m_pipe[2U];
+#endif
+
+	void wakeup();
+	void drain();
+};
+
+#endif
@@ -140,6 +140,6 @@ void CDummy::close()
 	LogDebug("Dummy: close called");
 }
 
-void CDummy::clockInt(unsigned int ms)
+void CDummy::clockInt()
 {
 }
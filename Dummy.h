@@ -63,7 +63,7 @@ protected:
 	virtual void writeCWInt();
 	virtual void clearCWInt();
 
-	virtual void clockInt(unsigned int ms);
+	virtual void clockInt();
 
 private:
 };
@@ -0,0 +1,96 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(EVENTQUEUE_H)
+#define	EVENTQUEUE_H
+
+#include <atomic>
+#include <cassert>
+
+// A bounded queue for exactly one producer thread and one consumer thread.
+// Each side only ever writes its own index, so no locks are needed; one
+// slot is always left empty to tell a full queue from an empty one.
+template<class T> class CEventQueue {
+public:
+	CEventQueue(unsigned int length) :
+	m_length(length + 1U),
+	m_buffer(nullptr),
+	m_iPtr(0U),
+	m_oPtr(0U)
+	{
+		assert(length > 0U);
+
+		m_buffer = new T[m_length];
+	}
+
+	~CEventQueue()
+	{
+		delete[] m_buffer;
+	}
+
+	// Producer side
+	bool put(const T& item)
+	{
+		unsigned int iPtr = m_iPtr.load(std::memory_order_relaxed);
+
+		unsigned int next = iPtr + 1U;
+		if (next == m_length)
+			next = 0U;
+
+		if (next == m_oPtr.load(std::memory_order_acquire))
+			return false;
+
+		m_buffer[iPtr] = item;
+
+		m_iPtr.store(next, std::memory_order_release);
+
+		return true;
+	}
+
+	// Consumer side
+	bool get(T& item)
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+
+		if (oPtr == m_iPtr.load(std::memory_order_acquire))
+			return false;
+
+		item = m_buffer[oPtr];
+
+		unsigned int next = oPtr + 1U;
+		if (next == m_length)
+			next = 0U;
+
+		m_oPtr.store(next, std::memory_order_release);
+
+		return true;
+	}
+
+	bool isEmpty() const
+	{
+		return m_oPtr.load(std::memory_order_acquire) == m_iPtr.load(std::memory_order_acquire);
+	}
+
+private:
+	unsigned int              m_length;
+	T*                        m_buffer;
+	std::atomic<unsigned int> m_iPtr;
+	std::atomic<unsigned int> m_oPtr;
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2016,2017,2018,2020,2021,2023,2025 by Jonathan Naylor G4KLX & Tony Corbett G0WFV
+ *   Copyright (C) 2016,2017,2018,2020,2021,2023,2025,2026 by Jonathan Naylor G4KLX & Tony Corbett G0WFV
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -66,7 +66,7 @@ m_displayClock(displayClock),
 m_utc(utc),
 m_fd(-1),
 m_dmr(false),
-m_clockDisplayTimer(1000U, 0U, 250U),   // Update the clock display every 250ms
+m_clockDisplayTimer(m_timers, 250U, [this]() { updateClock(); }),   // Update the clock display every 250ms
 m_rssiCount1(0U), 
 m_rssiCount2(0U)
 {
@@ -1033,12 +1033,10 @@ void CHD44780::clearCWInt()
 	::lcdPuts(m_fd, " Idle");
 }
 
-void CHD44780::clockInt(unsigned int ms)
+void CHD44780::updateClock()
 {
-	m_clockDisplayTimer.clock(ms);
-
 	// Idle clock display 
-	if (m_displayClock && m_clockDisplayTimer.isRunning() && m_clockDisplayTimer.hasExpired()) {
+	if (m_displayClock) {
 		time_t currentTime;
 		struct tm *Time;
 		::time(&currentTime);
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2016,2017,2018,2020,2021,2023,2025 by Jonathan Naylor G4KLX & Tony Corbett G0WFV
+ *   Copyright (C) 2016,2017,2018,2020,2021,2023,2025,2026 by Jonathan Naylor G4KLX & Tony Corbett G0WFV
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -133,8 +133,6 @@ protected:
 	virtual void writeCWInt();
 	virtual void clearCWInt();
 
-	virtual void clockInt(unsigned int ms);
-
 private:
 	std::string  m_callsign;
 	unsigned int m_id;
@@ -165,6 +163,8 @@ private:
 	CTimer       m_dstarScrollTimer;
 */
 
+	void updateClock();
+
 #ifdef USE_ADAFRUIT_DISPLAY
 	void adafruitLCDSetup();
 	void adafruitLCDColour(ADAFRUIT_COLOUR colour);
@@ -0,0 +1,339 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "JSONParser.h"
+
+#include <cassert>
+#include <cstring>
+
+IJSONHandler::~IJSONHandler()
+{
+}
+
+CJSONParser::CJSONParser() :
+m_ptr(nullptr),
+m_end(nullptr),
+m_handler(nullptr),
+m_key(),
+m_value()
+{
+}
+
+CJSONParser::~CJSONParser()
+{
+}
+
+bool CJSONParser::parse(const char* text, unsigned int length, IJSONHandler& handler)
+{
+	assert(text != nullptr);
+
+	m_ptr     = text;
+	m_end     = text + length;
+	m_handler = &handler;
+
+	skipSpace();
+
+	if (m_ptr >= m_end || *m_ptr != '{')
+		return false;
+
+	if (!parseObject(0U, ""))
+		return false;
+
+	skipSpace();
+
+	// Allow for a trailing NUL from the publisher
+	return m_ptr == m_end || (*m_ptr == '\0' && m_ptr + 1 == m_end);
+}
+
+void CJSONParser::skipSpace()
+{
+	while (m_ptr < m_end && (*m_ptr == ' ' || *m_ptr == '\t' || *m_ptr == '\r' || *m_ptr == '\n'))
+		m_ptr++;
+}
+
+bool CJSONParser::parseValue(unsigned int depth, const char* key)
+{
+	skipSpace();
+
+	if (m_ptr >= m_end)
+		return false;
+
+	switch (*m_ptr) {
+		case '{':
+			return parseObject(depth, key);
+		case '[':
+			return parseArray(depth);
+		case '"':
+			if (!parseString(m_value, JSON_MAX_VALUE_LENGTH))
+				return false;
+			m_handler->onValue(depth, key, JSON_TYPE::STRING, m_value);
+			return true;
+		case 't':
+			return parseLiteral("true", JSON_TYPE::BOOLEAN, depth, key);
+		case 'f':
+			return parseLiteral("false", JSON_TYPE::BOOLEAN, depth, key);
+		case 'n':
+			return parseLiteral("null", JSON_TYPE::NUL, depth, key);
+		default:
+			if (!parseNumber())
+				return false;
+			m_handler->onValue(depth, key, JSON_TYPE::NUMBER, m_value);
+			return true;
+	}
+}
+
+bool CJSONParser::parseObject(unsigned int depth, const char* key)
+{
+	// The values of an object are one level deeper than the object itself
+	if (depth >= JSON_MAX_DEPTH)
+		return false;
+
+	m_ptr++;		// The '{'
+
+	m_handler->onObjectStart(depth, key);
+
+	skipSpace();
+	if (m_ptr < m_end && *m_ptr == '}') {
+		m_ptr++;
+		m_handler->onObjectEnd(depth);
+		return true;
+	}
+
+	char* name = m_key[depth + 1U];
+
+	for (;;) {
+		skipSpace();
+		if (m_ptr >= m_end || *m_ptr != '"')
+			return false;
+
+		if (!parseString(name, JSON_MAX_KEY_LENGTH))
+			return false;
+
+		skipSpace();
+		if (m_ptr >= m_end || *m_ptr != ':')
+			return false;
+		m_ptr++;
+
+		if (!parseValue(depth + 1U, name))
+			return false;
+
+		skipSpace();
+		if (m_ptr >= m_end)
+			return false;
+
+		if (*m_ptr == ',') {
+			m_ptr++;
+		} else if (*m_ptr == '}') {
+			m_ptr++;
+			m_handler->onObjectEnd(depth);
+			return true;
+		} else {
+			return false;
+		}
+	}
+}
+
+bool CJSONParser::parseArray(unsigned int depth)
+{
+	if (depth >= JSON_MAX_DEPTH)
+		return false;
+
+	m_ptr++;		// The '['
+
+	skipSpace();
+	if (m_ptr < m_end && *m_ptr == ']') {
+		m_ptr++;
+		return true;
+	}
+
+	for (;;) {
+		if (!parseValue(depth + 1U, ""))
+			return false;
+
+		skipSpace();
+		if (m_ptr >= m_end)
+			return false;
+
+		if (*m_ptr == ',') {
+			m_ptr++;
+		} else if (*m_ptr == ']') {
+			m_ptr++;
+			return true;
+		} else {
+			return false;
+		}
+	}
+}
+
+static int hexValue(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+bool CJSONParser::parseHex4(unsigned int& code)
+{
+	if ((m_end - m_ptr) < 4)
+		return false;
+
+	code = 0U;
+	for (unsigned int i = 0U; i < 4U; i++) {
+		int v = hexValue(*m_ptr++);
+		if (v < 0)
+			return false;
+		code = (code << 4) | (unsigned int)v;
+	}
+
+	return true;
+}
+
+bool CJSONParser::parseString(char* buffer, unsigned int length)
+{
+	assert(buffer != nullptr);
+	assert(length > 0U);
+
+	m_ptr++;		// The opening '"'
+
+	unsigned int n = 0U;
+
+	while (m_ptr < m_end) {
+		char c = *m_ptr++;
+
+		if (c == '"') {
+			buffer[n] = '\0';
+			return true;
+		}
+
+		if (c != '\\') {
+			if (n < (length - 1U))
+				buffer[n++] = c;
+			continue;
+		}
+
+		if (m_ptr >= m_end)
+			return false;
+
+		c = *m_ptr++;
+
+		switch (c) {
+			case 'b': c = '\b'; break;
+			case 'f': c = '\f'; break;
+			case 'n': c = '\n'; break;
+			case 'r': c = '\r'; break;
+			case 't': c = '\t'; break;
+			case '"':
+			case '\\':
+			case '/':
+				break;
+			case 'u': {
+					unsigned int code = 0U;
+					if (!parseHex4(code))
+						return false;
+
+					// A high surrogate followed by a low one makes a single
+					// character beyond the BMP
+					if (code >= 0xD800U && code <= 0xDBFFU && (m_end - m_ptr) >= 6 && m_ptr[0U] == '\\' && m_ptr[1U] == 'u') {
+						const char* ptr = m_ptr;
+						m_ptr += 2;
+
+						unsigned int low = 0U;
+						if (parseHex4(low) && low >= 0xDC00U && low <= 0xDFFFU)
+							code = 0x10000U + ((code - 0xD800U) << 10) + (low - 0xDC00U);
+						else
+							m_ptr = ptr;
+					}
+
+					// Re-encode as UTF-8, an unpaired surrogate is replaced
+					unsigned char utf8[4U];
+					unsigned int len = 0U;
+					if (code < 0x80U) {
+						utf8[len++] = (unsigned char)code;
+					} else if (code < 0x800U) {
+						utf8[len++] = (unsigned char)(0xC0U | (code >> 6));
+						utf8[len++] = (unsigned char)(0x80U | (code & 0x3FU));
+					} else if (code >= 0xD800U && code <= 0xDFFFU) {
+						utf8[len++] = '?';
+					} else if (code < 0x10000U) {
+						utf8[len++] = (unsigned char)(0xE0U | (code >> 12));
+						utf8[len++] = (unsigned char)(0x80U | ((code >> 6) & 0x3FU));
+						utf8[len++] = (unsigned char)(0x80U | (code & 0x3FU));
+					} else {
+						utf8[len++] = (unsigned char)(0xF0U | (code >> 18));
+						utf8[len++] = (unsigned char)(0x80U | ((code >> 12) & 0x3FU));
+						utf8[len++] = (unsigned char)(0x80U | ((code >> 6) & 0x3FU));
+						utf8[len++] = (unsigned char)(0x80U | (code & 0x3FU));
+					}
+
+					// Never split a character when truncating
+					if ((n + len) < length) {
+						for (unsigned int i = 0U; i < len; i++)
+							buffer[n++] = char(utf8[i]);
+					}
+				}
+				continue;
+			default:
+				return false;
+		}
+
+		if (n < (length - 1U))
+			buffer[n++] = c;
+	}
+
+	return false;
+}
+
+bool CJSONParser::parseNumber()
+{
+	unsigned int n = 0U;
+
+	while (m_ptr < m_end) {
+		char c = *m_ptr;
+		if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+			if (n < (JSON_MAX_VALUE_LENGTH - 1U))
+				m_value[n++] = c;
+			m_ptr++;
+		} else {
+			break;
+		}
+	}
+
+	m_value[n] = '\0';
+
+	return n > 0U;
+}
+
+bool CJSONParser::parseLiteral(const char* literal, JSON_TYPE type, unsigned int depth, const char* key)
+{
+	assert(literal != nullptr);
+
+	unsigned int length = (unsigned int)::strlen(literal);
+	if ((unsigned int)(m_end - m_ptr) < length || ::memcmp(m_ptr, literal, length) != 0)
+		return false;
+
+	m_ptr += length;
+
+	m_handler->onValue(depth, key, type, literal);
+
+	return true;
+}
@@ -0,0 +1,74 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(JSONPARSER_H)
+#define	JSONPARSER_H
+
+enum class JSON_TYPE {
+	STRING,
+	NUMBER,
+	BOOLEAN,
+	NUL
+};
+
+const unsigned int JSON_MAX_DEPTH        = 8U;
+const unsigned int JSON_MAX_KEY_LENGTH   = 32U;
+const unsigned int JSON_MAX_VALUE_LENGTH = 256U;
+
+class IJSONHandler {
+public:
+	virtual ~IJSONHandler() = 0;
+
+	// The key is empty for the top level object and for array elements
+	virtual void onObjectStart(unsigned int depth, const char* key) = 0;
+	virtual void onObjectEnd(unsigned int depth) = 0;
+
+	// Strings are unescaped, anything else is passed as the raw text
+	virtual void onValue(unsigned int depth, const char* key, JSON_TYPE type, const char* value) = 0;
+
+private:
+};
+
+// A streaming JSON parser that reports values as they are found and never
+// allocates memory. Over long keys and values are truncated.
+class CJSONParser {
+public:
+	CJSONParser();
+	~CJSONParser();
+
+	bool parse(const char* text, unsigned int length, IJSONHandler& handler);
+
+private:
+	const char*   m_ptr;
+	const char*   m_end;
+	IJSONHandler* m_handler;
+	char          m_key[JSON_MAX_DEPTH + 1U][JSON_MAX_KEY_LENGTH];
+	char          m_value[JSON_MAX_VALUE_LENGTH];
+
+	bool parseValue(unsigned int depth, const char* key);
+	bool parseObject(unsigned int depth, const char* key);
+	bool parseArray(unsigned int depth);
+	bool parseString(char* buffer, unsigned int length);
+	bool parseHex4(unsigned int& code);
+	bool parseNumber();
+	bool parseLiteral(const char* literal, JSON_TYPE type, unsigned int depth, const char* key);
+
+	void skipSpace();
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Keywords.h"
+#include "Defines.h"
+
+#include <cassert>
+#include <cstring>
+
+// The compiler rejects duplicate case labels, so any collision between two
+// keywords is found at build time. The final compare rejects other text.
+#define	KEYWORD_CASE(text, keyword)	case hashKeyword(text): return ::strcmp(value, text) == 0 ? keyword : KEYWORD::UNKNOWN
+
+KEYWORD findKeyword(const char* value)
+{
+	assert(value != nullptr);
+
+	switch (hashKeyword(value)) {
+		KEYWORD_CASE("MMDVM",             KEYWORD::MMDVM);
+		KEYWORD_CASE("RSSI",              KEYWORD::RSSI);
+		KEYWORD_CASE("BER",               KEYWORD::BER);
+		KEYWORD_CASE("Text",              KEYWORD::TEXT);
+		KEYWORD_CASE("D-Star",            KEYWORD::DSTAR);
+		KEYWORD_CASE("DMR",               KEYWORD::DMR);
+		KEYWORD_CASE("YSF",               KEYWORD::YSF);
+		KEYWORD_CASE("P25",               KEYWORD::P25);
+		KEYWORD_CASE("NXDN",              KEYWORD::NXDN);
+		KEYWORD_CASE("POCSAG",            KEYWORD::POCSAG);
+		KEYWORD_CASE("FM",                KEYWORD::FM);
+		KEYWORD_CASE("M17",               KEYWORD::M17);
+
+		KEYWORD_CASE("mode",              KEYWORD::MODE);
+		KEYWORD_CASE("action",            KEYWORD::ACTION);
+		KEYWORD_CASE("source",            KEYWORD::SOURCE);
+		KEYWORD_CASE("source_cs",         KEYWORD::SOURCE_CS);
+		KEYWORD_CASE("source_ext",        KEYWORD::SOURCE_EXT);
+		KEYWORD_CASE("source_info",       KEYWORD::SOURCE_INFO);
+		KEYWORD_CASE("destination_cs",    KEYWORD::DESTINATION_CS);
+		KEYWORD_CASE("destination_id",    KEYWORD::DESTINATION_ID);
+		KEYWORD_CASE("destination_type",  KEYWORD::DESTINATION_TYPE);
+		KEYWORD_CASE("reflector",         KEYWORD::REFLECTOR);
+		KEYWORD_CASE("slot",              KEYWORD::SLOT);
+		KEYWORD_CASE("dg-id",             KEYWORD::DG_ID);
+		KEYWORD_CASE("value",             KEYWORD::VALUE);
+		KEYWORD_CASE("functional",        KEYWORD::FUNCTIONAL);
+		KEYWORD_CASE("ric",               KEYWORD::RIC);
+		KEYWORD_CASE("message",           KEYWORD::MESSAGE);
+		KEYWORD_CASE("state",             KEYWORD::STATE);
+
+		KEYWORD_CASE("idle",              KEYWORD::IDLE);
+		KEYWORD_CASE("CW",                KEYWORD::CW);
+		KEYWORD_CASE("lockout",           KEYWORD::LOCKOUT);
+		KEYWORD_CASE("error",             KEYWORD::ERROR_MODE);
+		KEYWORD_CASE("start",             KEYWORD::START);
+		KEYWORD_CASE("late_entry",        KEYWORD::LATE_ENTRY);
+		KEYWORD_CASE("end",               KEYWORD::END);
+		KEYWORD_CASE("lost",              KEYWORD::LOST);
+		KEYWORD_CASE("rf",                KEYWORD::RF);
+		KEYWORD_CASE("network",           KEYWORD::NETWORK);
+		KEYWORD_CASE("group",             KEYWORD::GROUP);
+		KEYWORD_CASE("listening",         KEYWORD::LISTENING);
+		KEYWORD_CASE("kerchunk_rf",       KEYWORD::KERCHUNK_RF);
+		KEYWORD_CASE("relaying_rf",       KEYWORD::RELAYING_RF);
+		KEYWORD_CASE("relaying_wait_rf",  KEYWORD::RELAYING_WAIT_RF);
+		KEYWORD_CASE("timeout_wait_rf",   KEYWORD::TIMEOUT_WAIT_RF);
+		KEYWORD_CASE("timeout_rf",        KEYWORD::TIMEOUT_RF);
+		KEYWORD_CASE("hang",              KEYWORD::HANG);
+		KEYWORD_CASE("kerchunk_ext",      KEYWORD::KERCHUNK_EXT);
+		KEYWORD_CASE("relaying_ext",      KEYWORD::RELAYING_EXT);
+		KEYWORD_CASE("relaying_wait_ext", KEYWORD::RELAYING_WAIT_EXT);
+		KEYWORD_CASE("timeout_wait_ext",  KEYWORD::TIMEOUT_WAIT_EXT);
+		KEYWORD_CASE("timeout_ext",       KEYWORD::TIMEOUT_EXT);
+
+		default:
+			return KEYWORD::UNKNOWN;
+	}
+}
+
+unsigned char getKeywordMode(KEYWORD keyword)
+{
+	switch (keyword) {
+		case KEYWORD::DSTAR:      return MODE_DSTAR;
+		case KEYWORD::DMR:        return MODE_DMR;
+		case KEYWORD::YSF:        return MODE_YSF;
+		case KEYWORD::P25:        return MODE_P25;
+		case KEYWORD::NXDN:       return MODE_NXDN;
+		case KEYWORD::POCSAG:     return MODE_POCSAG;
+		case KEYWORD::M17:        return MODE_M17;
+		case KEYWORD::FM:         return MODE_FM;
+		case KEYWORD::CW:         return MODE_CW;
+		case KEYWORD::LOCKOUT:    return MODE_LOCKOUT;
+		case KEYWORD::ERROR_MODE: return MODE_ERROR;
+		default:                  return MODE_IDLE;
+	}
+}
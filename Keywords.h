@@ -0,0 +1,96 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(KEYWORDS_H)
+#define	KEYWORDS_H
+
+// Every key and value in the MMDVMHost JSON that the display cares about
+enum class KEYWORD : unsigned char {
+	UNKNOWN,
+
+	// The message types, also used as mode names
+	MMDVM,
+	RSSI,
+	BER,
+	TEXT,
+	DSTAR,
+	DMR,
+	YSF,
+	P25,
+	NXDN,
+	POCSAG,
+	FM,
+	M17,
+
+	// The field names
+	MODE,
+	ACTION,
+	SOURCE,
+	SOURCE_CS,
+	SOURCE_EXT,
+	SOURCE_INFO,
+	DESTINATION_CS,
+	DESTINATION_ID,
+	DESTINATION_TYPE,
+	REFLECTOR,
+	SLOT,
+	DG_ID,
+	VALUE,
+	FUNCTIONAL,
+	RIC,
+	MESSAGE,
+	STATE,
+
+	// The field values
+	IDLE,
+	CW,
+	LOCKOUT,
+	ERROR_MODE,		// ERROR is a macro on Windows
+	START,
+	LATE_ENTRY,
+	END,
+	LOST,
+	RF,
+	NETWORK,
+	GROUP,
+	LISTENING,
+	KERCHUNK_RF,
+	RELAYING_RF,
+	RELAYING_WAIT_RF,
+	TIMEOUT_WAIT_RF,
+	TIMEOUT_RF,
+	HANG,
+	KERCHUNK_EXT,
+	RELAYING_EXT,
+	RELAYING_WAIT_EXT,
+	TIMEOUT_WAIT_EXT,
+	TIMEOUT_EXT
+};
+
+// FNV-1a, usable at compile time so that keywords can be switch labels
+constexpr unsigned int hashKeyword(const char* text, unsigned int hash = 2166136261U)
+{
+	return *text == '\0' ? hash : hashKeyword(text + 1, (hash ^ (unsigned char)*text) * 16777619U);
+}
+
+extern KEYWORD findKeyword(const char* text);
+
+// Returns the MODE_* value for a mode name, or MODE_IDLE if it isn't one
+extern unsigned char getKeywordMode(KEYWORD keyword);
+
+#endif
@@ -107,7 +107,7 @@ m_displayClock(displayClock),
 m_utc(utc),
 m_dimOnIdle(dimOnIdle),
 m_dmr(false),
-m_clockDisplayTimer(1000U, 0U, 250U)   // Update the clock display every 250ms
+m_clockDisplayTimer(m_timers, 250U, [this]() { updateClock(); })   // Update the clock display every 250ms
 {
 }
 
@@ -526,12 +526,19 @@ void CLCDproc::clearCWInt()
 {
 }
 
-void CLCDproc::clockInt(unsigned int ms)
+int CLCDproc::getFD() const
 {
-	m_clockDisplayTimer.clock(ms);
+#if defined(_WIN32) || defined(_WIN64)
+	return -1;
+#else
+	return m_socketfd;
+#endif
+}
 
+void CLCDproc::updateClock()
+{
 	// Idle clock display
-	if (m_displayClock && m_clockDisplayTimer.isRunning() && m_clockDisplayTimer.hasExpired()) {
+	if (m_displayClock) {
 		time_t currentTime;
 		struct tm *Time;
 		time(&currentTime);
@@ -554,7 +561,10 @@ void CLCDproc::clockInt(unsigned int ms)
 
 		m_clockDisplayTimer.start();
 	}
+}
 
+void CLCDproc::clockInt()
+{
 	// We must set all this information on each select we do
 	FD_ZERO(&m_readfds);   // empty readfds
 
@@ -41,6 +41,8 @@ public:
 
 	virtual void close();
 
+	virtual int getFD() const;
+
 protected:
 	virtual void setIdleInt();
 	virtual void setErrorInt();
@@ -77,7 +79,7 @@ protected:
 	virtual void writeCWInt();
 	virtual void clearCWInt();
 
-	virtual void clockInt(unsigned int ms);
+	virtual void clockInt();
 
 private:
 	std::string  m_callsign;
@@ -98,6 +100,7 @@ private:
 	int  socketPrintf(int fd, const char* format, ...);
 #endif
 	void defineScreens();
+	void updateClock();
 };
 
 #endif
@@ -17,6 +17,7 @@
  */
 
 #include "MQTTConnection.h"
+#include "Metrics.h"
 
 #include <cassert>
 #include <cstdio>
@@ -27,34 +28,85 @@
 #include <process.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
 #endif
 
-CMQTTConnection::CMQTTConnection(const std::string& host, unsigned short port, const std::string& name, const bool authEnabled, const std::string& username, const std::string& password, const std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>>& subs, unsigned int keepalive, MQTT_QOS qos) :
+// The messages kept for a topic that has no queue length of its own
+const unsigned int DEFAULT_QUEUE_LENGTH = 100U;
+
+CMQTTConnection::CMQTTConnection(const std::string& host, unsigned short port, const std::string& name, const bool authEnabled, const std::string& username, const std::string& password, const std::vector<std::pair<std::string, MQTTHandler>>& subs, unsigned int keepalive, MQTT_QOS qos) :
 m_host(host),
 m_port(port),
 m_name(name),
 m_authEnabled(authEnabled),
 m_username(username),
 m_password(password),
-m_subs(subs),
+m_topics(),
+m_dispatcher(),
 m_keepalive(keepalive),
 m_qos(qos),
 m_mosq(nullptr),
-m_connected(false)
+m_connected(false),
+m_policies(),
+m_outbound(),
+m_pending(0U),
+m_pendingLevel(0U),
+m_sending(),
+m_mutex()
 {
 	assert(!host.empty());
 	assert(port > 0U);
 	assert(!name.empty());
 	assert(keepalive >= 5U);
 
+#if !defined(_WIN32) && !defined(_WIN64)
+	m_pipe[0U] = -1;
+	m_pipe[1U] = -1;
+#endif
+
+	for (const auto& it : subs)
+		subscribe(it.first, it.second);
+
 	::mosquitto_lib_init();
 }
 
 CMQTTConnection::~CMQTTConnection()
 {
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_pipe[0U] != -1)
+		::close(m_pipe[0U]);
+	if (m_pipe[1U] != -1)
+		::close(m_pipe[1U]);
+#endif
+
 	::mosquitto_lib_cleanup();
 }
 
+void CMQTTConnection::setPolicy(const std::string& topic, MQTT_QOS qos, bool retain, unsigned int length, MQTT_OVERFLOW overflow)
+{
+	assert(!topic.empty());
+
+	CPolicy policy;
+	policy.m_topic    = (topic.find('/') == std::string::npos) ? m_name + "/" + topic : topic;
+	policy.m_qos      = qos;
+	policy.m_retain   = retain;
+	policy.m_length   = (length == 0U) ? DEFAULT_QUEUE_LENGTH : length;
+	policy.m_overflow = overflow;
+
+	m_policies.push_back(policy);
+}
+
+void CMQTTConnection::subscribe(const std::string& topic, const MQTTHandler& handler)
+{
+	assert(!topic.empty());
+	assert(handler);
+
+	std::string topicEx = (topic.find('/') == std::string::npos) ? m_name + "/" + topic : topic;
+
+	m_topics.push_back(topicEx);
+	m_dispatcher.add(topicEx, handler);
+}
+
 bool CMQTTConnection::open()
 {
 	char name[50U];
@@ -66,6 +118,21 @@ bool CMQTTConnection::open()
 
 	::fprintf(stdout, "Display-Driver (%s) connecting to MQTT as %s\n", m_name.c_str(), name);
 
+#if !defined(_WIN32) && !defined(_WIN64)
+	// The pipe lets other threads interrupt the poll() in the main loop
+	if (m_pipe[0U] == -1) {
+		if (::pipe(m_pipe) == -1) {
+			::fprintf(stderr, "MQTT Error creating the wake up pipe\n");
+			return false;
+		}
+
+		for (unsigned int i = 0U; i < 2U; i++) {
+			int flags = ::fcntl(m_pipe[i], F_GETFL, 0);
+			::fcntl(m_pipe[i], F_SETFL, flags | O_NONBLOCK);
+		}
+	}
+#endif
+
 	m_mosq = ::mosquitto_new(name, true, this);
 	if (m_mosq == nullptr){
 		::fprintf(stderr, "MQTT Error newing: Out of memory.\n");
@@ -111,40 +178,179 @@ bool CMQTTConnection::publish(const char* topic, const unsigned char* data, unsi
 	assert(topic != nullptr);
 	assert(data != nullptr);
 
-	if (!m_connected)
-		return false;
+	std::string topicEx = (::strchr(topic, '/') == nullptr) ? m_name + "/" + topic : topic;
 
-	if (::strchr(topic, '/') == nullptr) {
-		char topicEx[100U];
-		::sprintf(topicEx, "%s/%s", m_name.c_str(), topic);
+	m_mutex.lock();
 
-		int rc = ::mosquitto_publish(m_mosq, nullptr, topicEx, len, data, static_cast<int>(m_qos), false);
-		if (rc != MOSQ_ERR_SUCCESS) {
-			::fprintf(stderr, "MQTT Error publishing: %s\n", ::mosquitto_strerror(rc));
-			return false;
-		}
-	} else {
-		int rc = ::mosquitto_publish(m_mosq, nullptr, topic, len, data, static_cast<int>(m_qos), false);
-		if (rc != MOSQ_ERR_SUCCESS) {
-			::fprintf(stderr, "MQTT Error publishing: %s\n", ::mosquitto_strerror(rc));
-			return false;
+	auto it = m_outbound.find(topicEx);
+	if (it == m_outbound.end()) {
+		COutbound outbound;
+		outbound.m_policy  = getPolicy(topicEx);
+		outbound.m_dropped = 0U;
+
+		it = m_outbound.insert(std::make_pair(topicEx, outbound)).first;
+	}
+
+	COutbound& outbound = it->second;
+
+	// While the broker is slow or away each topic keeps no more than its
+	// own share of messages
+	if (outbound.m_messages.size() >= outbound.m_policy.m_length) {
+		outbound.m_dropped++;
+
+		switch (outbound.m_policy.m_overflow) {
+			case MQTT_OVERFLOW::DROP_NEWEST:
+				m_mutex.unlock();
+				return false;
+			case MQTT_OVERFLOW::COALESCE:
+				outbound.m_messages.back().assign((const char*)data, len);
+				m_mutex.unlock();
+				return true;
+			default:
+				outbound.m_messages.pop_front();
+				m_pending--;
+				break;
 		}
 	}
 
+	outbound.m_messages.push_back(std::string((const char*)data, len));
+
+	bool wake = (m_pending++ == 0U);
+
+	m_mutex.unlock();
+
+	if (wake)
+		wakeup();
+
 	return true;
 }
 
+void CMQTTConnection::sendQueued()
+{
+	// Only hand libmosquitto more once it has written out what it already
+	// has, so that a slow broker backs up into the bounded queues
+	if (!m_connected || m_pending.load() == 0U || ::mosquitto_want_write(m_mosq))
+		return;
+
+	unsigned int dropped = 0U;
+
+	m_mutex.lock();
+
+	::MetricsLevel(METRIC_LEVEL::MQTT_OUTBOUND, m_pendingLevel, m_pending.load());
+
+	for (auto& it : m_outbound) {
+		COutbound& outbound = it.second;
+
+		while (!outbound.m_messages.empty()) {
+			CMessage message;
+			message.m_topic   = &it.first;
+			message.m_policy  = &outbound.m_policy;
+			message.m_payload = std::move(outbound.m_messages.front());
+			m_sending.push_back(std::move(message));
+
+			outbound.m_messages.pop_front();
+		}
+
+		if (outbound.m_dropped > 0U) {
+			::fprintf(stderr, "MQTT: %u messages dropped for %s\n", outbound.m_dropped, it.first.c_str());
+			dropped += outbound.m_dropped;
+			outbound.m_dropped = 0U;
+		}
+	}
+
+	m_pending.store(0U);
+
+	m_mutex.unlock();
+
+	if (dropped > 0U)
+		::MetricsCount(METRIC_COUNT::MQTT_DROPPED, dropped);
+
+	// The map only grows, so the topic and policy pointers stay valid
+	for (const auto& it : m_sending) {
+		int rc = ::mosquitto_publish(m_mosq, nullptr, it.m_topic->c_str(), (int)it.m_payload.size(), it.m_payload.data(), static_cast<int>(it.m_policy->m_qos), it.m_policy->m_retain);
+		if (rc != MOSQ_ERR_SUCCESS)
+			::fprintf(stderr, "MQTT Error publishing: %s\n", ::mosquitto_strerror(rc));
+	}
+
+	m_sending.clear();
+}
+
+void CMQTTConnection::wakeup()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	// A full pipe already guarantees a wake up, so the result doesn't matter
+	if (m_pipe[1U] != -1) {
+		unsigned char c = 0x00U;
+		ssize_t n = ::write(m_pipe[1U], &c, 1U);
+		(void)n;
+	}
+#endif
+}
+
+CMQTTConnection::CPolicy CMQTTConnection::getPolicy(const std::string& topic) const
+{
+	for (const auto& it : m_policies) {
+		if (matches(it.m_topic, topic))
+			return it;
+	}
+
+	CPolicy policy;
+	policy.m_topic    = topic;
+	policy.m_qos      = m_qos;
+	policy.m_retain   = false;
+	policy.m_length   = DEFAULT_QUEUE_LENGTH;
+	policy.m_overflow = MQTT_OVERFLOW::DROP_OLDEST;
+
+	return policy;
+}
+
+bool CMQTTConnection::matches(const std::string& filter, const std::string& topic)
+{
+	std::string::size_type f = 0U;
+	std::string::size_type t = 0U;
+
+	for (;;) {
+		std::string::size_type fEnd = filter.find('/', f);
+		std::string::size_type tEnd = topic.find('/', t);
+
+		std::string level = filter.substr(f, (fEnd == std::string::npos) ? std::string::npos : fEnd - f);
+		if (level == "#")
+			return true;
+
+		if (level != "+" && topic.compare(t, (tEnd == std::string::npos) ? std::string::npos : tEnd - t, level) != 0)
+			return false;
+
+		// A trailing # also matches the level above it, so a/# takes in a
+		if (tEnd == std::string::npos && fEnd != std::string::npos)
+			return filter.compare(fEnd, std::string::npos, "/#") == 0;
+
+		if (fEnd == std::string::npos || tEnd == std::string::npos)
+			return fEnd == tEnd;
+
+		f = fEnd + 1U;
+		t = tEnd + 1U;
+	}
+}
+
 int CMQTTConnection::loop()
 {
 	if (m_mosq == nullptr)
 		return -1;
 
+#if !defined(_WIN32) && !defined(_WIN64)
+	unsigned char buffer[16U];
+	while (::read(m_pipe[0U], buffer, 16U) > 0)
+		;
+#endif
+
 	int rc = ::mosquitto_loop(m_mosq, 0, 1);
 	if (rc != MOSQ_ERR_SUCCESS && rc != MOSQ_ERR_NO_CONN) {
 		// Connection lost — try to reconnect.
 		::mosquitto_reconnect(m_mosq);
 	}
 
+	sendQueued();
+
 	return rc;
 }
 
@@ -153,9 +359,39 @@ bool CMQTTConnection::isConnected() const
 	return m_connected;
 }
 
+int CMQTTConnection::getSocket() const
+{
+	if (m_mosq == nullptr)
+		return -1;
+
+	return ::mosquitto_socket(m_mosq);
+}
+
+bool CMQTTConnection::wantWrite() const
+{
+	if (m_mosq == nullptr)
+		return false;
+
+	if (m_connected && m_pending.load() > 0U)
+		return true;
+
+	return ::mosquitto_want_write(m_mosq);
+}
+
+int CMQTTConnection::getWakeFD() const
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	return m_pipe[0U];
+#else
+	return -1;
+#endif
+}
+
 void CMQTTConnection::close()
 {
 	if (m_mosq != nullptr) {
+		sendQueued();
+
 		::mosquitto_disconnect(m_mosq);
 		::mosquitto_destroy(m_mosq);
 		m_mosq = nullptr;
@@ -176,28 +412,15 @@ void CMQTTConnection::onConnect(mosquitto* mosq, void* obj, int rc)
 	CMQTTConnection* p = static_cast<CMQTTConnection*>(obj);
 	p->m_connected = true;
 
-	for (std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>>::const_iterator it = p->m_subs.cbegin(); it != p->m_subs.cend(); ++it) {
-		std::string topic = (*it).first;
+	for (const auto& topic : p->m_topics) {
+		MQTT_QOS qos = p->getPolicy(topic).m_qos;
 
-		if (topic.find_first_of('/') == std::string::npos) {
-			char topicEx[100U];
-			::sprintf(topicEx, "%s/%s", p->m_name.c_str(), topic.c_str());
-
-			rc = ::mosquitto_subscribe(mosq, nullptr, topicEx, static_cast<int>(p->m_qos));
-			if (rc != MOSQ_ERR_SUCCESS) {
-				::fprintf(stderr, "MQTT: error subscribing to %s - %s\n", topicEx, ::mosquitto_strerror(rc));
-				::mosquitto_disconnect(mosq);
-			} else {
-				::fprintf(stdout, "MQTT: subscribed to %s\n", topicEx);
-			}
+		rc = ::mosquitto_subscribe(mosq, nullptr, topic.c_str(), static_cast<int>(qos));
+		if (rc != MOSQ_ERR_SUCCESS) {
+			::fprintf(stderr, "MQTT: error subscribing to %s - %s\n", topic.c_str(), ::mosquitto_strerror(rc));
+			::mosquitto_disconnect(mosq);
 		} else {
-			rc = ::mosquitto_subscribe(mosq, nullptr, topic.c_str(), static_cast<int>(p->m_qos));
-			if (rc != MOSQ_ERR_SUCCESS) {
-				::fprintf(stderr, "MQTT: error subscribing to %s - %s\n", topic.c_str(), ::mosquitto_strerror(rc));
-				::mosquitto_disconnect(mosq);
-			} else {
-				::fprintf(stdout, "MQTT: subscribed to %s\n", topic.c_str());
-			}
+			::fprintf(stdout, "MQTT: subscribed to %s at QoS %d\n", topic.c_str(), static_cast<int>(qos));
 		}
 	}
 }
@@ -220,12 +443,10 @@ void CMQTTConnection::onMessage(mosquitto* mosq, void* obj, const mosquitto_mess
 
 	CMQTTConnection* p = static_cast<CMQTTConnection*>(obj);
 
-	for (const auto& it : p->m_subs) {
-		if (::strcmp(it.first.c_str(), message->topic) == 0) {
-			it.second((unsigned char*)message->payload, message->payloadlen);
-			break;
-		}
-	}
+	if (message->payloadlen <= 0)
+		return;
+
+	p->m_dispatcher.dispatch(message->topic, (unsigned char*)message->payload, message->payloadlen);
 }
 
 void CMQTTConnection::onDisconnect(mosquitto* mosq, void* obj, int rc)
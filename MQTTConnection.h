@@ -19,10 +19,16 @@
 #if !defined(MQTTPUBLISHER_H)
 #define	MQTTPUBLISHER_H
 
+#include "MQTTDispatcher.h"
+#include "Mutex.h"
+
 #include <mosquitto.h>
 
+#include <unordered_map>
+#include <atomic>
 #include <vector>
 #include <string>
+#include <deque>
 
 enum class MQTT_QOS : int {
 	AT_MODE_ONCE  = 0,
@@ -30,17 +36,45 @@ enum class MQTT_QOS : int {
 	EXACTLY_ONCE  = 2
 };
 
+// What happens to a message published to a topic whose queue is full
+enum class MQTT_OVERFLOW : unsigned int {
+	DROP_OLDEST = 0,
+	DROP_NEWEST = 1,
+	COALESCE    = 2		// Replaces the newest message still waiting
+};
+
 class CMQTTConnection {
 public:
-	CMQTTConnection(const std::string& host, unsigned short port, const std::string& name, const bool authEnabled, const std::string& username, const std::string& password, const std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>>& subs, unsigned int keepalive, MQTT_QOS qos = MQTT_QOS::EXACTLY_ONCE);
+	CMQTTConnection(const std::string& host, unsigned short port, const std::string& name, const bool authEnabled, const std::string& username, const std::string& password, const std::vector<std::pair<std::string, MQTTHandler>>& subs, unsigned int keepalive, MQTT_QOS qos = MQTT_QOS::EXACTLY_ONCE);
 	~CMQTTConnection();
 
+	// The QoS, retain flag and outbound queue for topics matching this one,
+	// where a topic without a / is taken to be under our name and + matches
+	// any one level. The first match wins, anything unmatched uses the
+	// default QoS. A length of 0 gives the default queue length.
+	void setPolicy(const std::string& topic, MQTT_QOS qos, bool retain, unsigned int length = 0U, MQTT_OVERFLOW overflow = MQTT_OVERFLOW::DROP_OLDEST);
+
+	// Calls the handler for messages on topics matching this one, which may
+	// contain + and # wildcards. Must be called before open().
+	void subscribe(const std::string& topic, const MQTTHandler& handler);
+
 	bool open();
 
+	// Whether the topic is covered by the filter and its + and # wildcards
+	static bool matches(const std::string& filter, const std::string& topic);
+
 	int loop();
 
 	bool isConnected() const;
 
+	int  getSocket() const;
+	bool wantWrite() const;
+
+	// Becomes readable when a message is queued from another thread
+	int  getWakeFD() const;
+
+	// Messages are queued and only sent from loop(), so these are safe to
+	// call from any thread
 	bool publish(const char* topic, const char* text);
 	bool publish(const char* topic, const std::string& text);
 	bool publish(const char* topic, const unsigned char* data, unsigned int len);
@@ -54,12 +88,48 @@ private:
 	bool           m_authEnabled;
 	std::string    m_username;
 	std::string    m_password;
-	std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>> m_subs;
+	std::vector<std::string> m_topics;
+	CMQTTDispatcher m_dispatcher;
 	unsigned int   m_keepalive;
 	MQTT_QOS       m_qos;
 	mosquitto*     m_mosq;
 	bool           m_connected;
 
+	struct CPolicy {
+		std::string   m_topic;
+		MQTT_QOS      m_qos;
+		bool          m_retain;
+		unsigned int  m_length;
+		MQTT_OVERFLOW m_overflow;
+	};
+
+	struct COutbound {
+		CPolicy                 m_policy;
+		std::deque<std::string> m_messages;
+		unsigned int            m_dropped;
+	};
+
+	struct CMessage {
+		const std::string* m_topic;
+		const CPolicy*     m_policy;
+		std::string        m_payload;
+	};
+
+	std::vector<CPolicy> m_policies;
+	std::unordered_map<std::string, COutbound> m_outbound;
+	std::atomic<unsigned int> m_pending;
+	unsigned int         m_pendingLevel;
+	std::vector<CMessage> m_sending;
+	CMutex               m_mutex;
+#if !defined(_WIN32) && !defined(_WIN64)
+	int                  m_pipe[2U];
+#endif
+
+	CPolicy getPolicy(const std::string& topic) const;
+
+	void sendQueued();
+	void wakeup();
+
 	static void onConnect(mosquitto* mosq, void* obj, int rc);
 	static void onSubscribe(mosquitto* mosq, void* obj, int mid, int qosCount, const int* grantedQOS);
 	static void onMessage(mosquitto* mosq, void* obj, const mosquitto_message* message);
@@ -0,0 +1,160 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "MQTTDispatcher.h"
+
+#include <cassert>
+#include <cstring>
+
+CMQTTDispatcher::CMQTTDispatcher() :
+m_exact(),
+m_root(nullptr),
+m_wildcards(false)
+{
+	m_root = new CNode;
+}
+
+CMQTTDispatcher::~CMQTTDispatcher()
+{
+	destroy(m_root);
+}
+
+void CMQTTDispatcher::add(const std::string& topic, const MQTTHandler& handler)
+{
+	assert(!topic.empty());
+	assert(handler);
+
+	if (topic.find_first_of("+#") == std::string::npos) {
+		m_exact[topic].push_back(handler);
+		return;
+	}
+
+	CNode* node = m_root;
+
+	std::string::size_type start = 0U;
+	for (;;) {
+		std::string::size_type end = topic.find('/', start);
+		std::string level = topic.substr(start, (end == std::string::npos) ? std::string::npos : end - start);
+
+		auto it = node->m_children.find(level);
+		if (it == node->m_children.end())
+			it = node->m_children.insert(std::make_pair(level, new CNode)).first;
+
+		node = it->second;
+
+		if (end == std::string::npos)
+			break;
+
+		start = end + 1U;
+	}
+
+	node->m_handlers.push_back(handler);
+	m_wildcards = true;
+}
+
+bool CMQTTDispatcher::dispatch(const char* topic, const unsigned char* data, unsigned int length) const
+{
+	assert(topic != nullptr);
+
+	bool found = false;
+
+	auto it = m_exact.find(topic);
+	if (it != m_exact.end()) {
+		for (const auto& handler : it->second)
+			handler(data, length);
+		found = true;
+	}
+
+	if (m_wildcards && match(m_root, topic, true, data, length))
+		found = true;
+
+	return found;
+}
+
+bool CMQTTDispatcher::match(const CNode* node, const char* level, bool first, const unsigned char* data, unsigned int length) const
+{
+	assert(node != nullptr);
+	assert(level != nullptr);
+
+	bool found = false;
+
+	// Wildcards never match the $ topics at the top level
+	bool wild = !first || level[0U] != '$';
+
+	// # takes everything from here down
+	if (wild) {
+		auto it = node->m_children.find("#");
+		if (it != node->m_children.end()) {
+			for (const auto& handler : it->second->m_handlers)
+				handler(data, length);
+			found = true;
+		}
+	}
+
+	const char* end = ::strchr(level, '/');
+	std::string name = (end == nullptr) ? std::string(level) : std::string(level, end - level);
+
+	auto it = node->m_children.find(name);
+	if (it != node->m_children.end()) {
+		if (end == nullptr)
+			found = deliver(it->second, data, length) || found;
+		else
+			found = match(it->second, end + 1, false, data, length) || found;
+	}
+
+	if (wild) {
+		it = node->m_children.find("+");
+		if (it != node->m_children.end()) {
+			if (end == nullptr)
+				found = deliver(it->second, data, length) || found;
+			else
+				found = match(it->second, end + 1, false, data, length) || found;
+		}
+	}
+
+	return found;
+}
+
+bool CMQTTDispatcher::deliver(const CNode* node, const unsigned char* data, unsigned int length) const
+{
+	assert(node != nullptr);
+
+	for (const auto& handler : node->m_handlers)
+		handler(data, length);
+
+	bool found = !node->m_handlers.empty();
+
+	// A trailing # also matches the level before it
+	auto it = node->m_children.find("#");
+	if (it != node->m_children.end()) {
+		for (const auto& handler : it->second->m_handlers)
+			handler(data, length);
+		found = true;
+	}
+
+	return found;
+}
+
+void CMQTTDispatcher::destroy(CNode* node)
+{
+	for (auto& it : node->m_children)
+		destroy(it.second);
+
+	delete node;
+}
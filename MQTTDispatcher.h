@@ -0,0 +1,58 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#if !defined(MQTTDISPATCHER_H)
+#define	MQTTDISPATCHER_H
+
+#include <unordered_map>
+#include <functional>
+#include <string>
+#include <vector>
+
+typedef std::function<void(const unsigned char* data, unsigned int length)> MQTTHandler;
+
+// Finds the handlers for an incoming topic. Plain topics are looked up
+// directly, those with + or # wildcards are kept in a tree with one level
+// of the topic per node and are only walked when there are any.
+class CMQTTDispatcher {
+public:
+	CMQTTDispatcher();
+	~CMQTTDispatcher();
+
+	void add(const std::string& topic, const MQTTHandler& handler);
+
+	// Returns false when nothing was subscribed to the topic
+	bool dispatch(const char* topic, const unsigned char* data, unsigned int length) const;
+
+private:
+	struct CNode {
+		std::unordered_map<std::string, CNode*> m_children;
+		std::vector<MQTTHandler>                m_handlers;
+	};
+
+	std::unordered_map<std::string, std::vector<MQTTHandler>> m_exact;
+	CNode* m_root;
+	bool   m_wildcards;
+
+	bool match(const CNode* node, const char* level, bool first, const unsigned char* data, unsigned int length) const;
+	bool deliver(const CNode* node, const unsigned char* data, unsigned int length) const;
+	void destroy(CNode* node);
+};
+
+#endif
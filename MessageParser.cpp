@@ -0,0 +1,549 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "MessageParser.h"
+#include "Defines.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+
+// A bit for each field seen in the message
+const unsigned int FIELD_MODE             = 0x00001U;
+const unsigned int FIELD_ACTION           = 0x00002U;
+const unsigned int FIELD_SOURCE           = 0x00004U;
+const unsigned int FIELD_SOURCE_CS        = 0x00008U;
+const unsigned int FIELD_SOURCE_EXT       = 0x00010U;
+const unsigned int FIELD_DESTINATION_CS   = 0x00020U;
+const unsigned int FIELD_DESTINATION_TYPE = 0x00040U;
+const unsigned int FIELD_DESTINATION_ID   = 0x00080U;
+const unsigned int FIELD_REFLECTOR        = 0x00100U;
+const unsigned int FIELD_FUNCTIONAL       = 0x00200U;
+const unsigned int FIELD_STATE            = 0x00400U;
+const unsigned int FIELD_SOURCE_INFO      = 0x00800U;
+const unsigned int FIELD_MESSAGE          = 0x01000U;
+const unsigned int FIELD_VALUE            = 0x02000U;
+const unsigned int FIELD_SLOT             = 0x04000U;
+const unsigned int FIELD_DG_ID            = 0x08000U;
+const unsigned int FIELD_RIC              = 0x10000U;
+
+static void copyField(char* dest, unsigned int length, const char* value)
+{
+	::strncpy(dest, value, length - 1U);
+	dest[length - 1U] = '\0';
+}
+
+CMessageParser::CMessageParser() :
+m_parser(),
+m_event(nullptr),
+m_type(KEYWORD::UNKNOWN),
+m_done(false),
+m_result(false),
+m_fields(0U),
+m_mode(KEYWORD::UNKNOWN),
+m_action(KEYWORD::UNKNOWN),
+m_source(KEYWORD::UNKNOWN),
+m_destinationType(KEYWORD::UNKNOWN),
+m_functional(KEYWORD::UNKNOWN),
+m_state(KEYWORD::UNKNOWN),
+m_valueType(JSON_TYPE::NUL),
+m_slot(0),
+m_destinationId(0),
+m_dgId(0),
+m_ric(0)
+{
+}
+
+CMessageParser::~CMessageParser()
+{
+}
+
+bool CMessageParser::parse(const char* text, unsigned int length, CDisplayEvent& event)
+{
+	assert(text != nullptr);
+
+	m_event  = &event;
+	m_type   = KEYWORD::UNKNOWN;
+	m_done   = false;
+	m_result = false;
+	m_fields = 0U;
+	m_slot   = 0;
+
+	if (!m_parser.parse(text, length, *this)) {
+		LogError("Error parsing: \"%.*s\"", int(length), text);
+		return false;
+	}
+
+	return m_result;
+}
+
+bool CMessageParser::has(unsigned int fields) const
+{
+	return (m_fields & fields) == fields;
+}
+
+bool CMessageParser::isStart() const
+{
+	return m_action == KEYWORD::START || m_action == KEYWORD::LATE_ENTRY;
+}
+
+bool CMessageParser::isEnd() const
+{
+	return m_action == KEYWORD::END || m_action == KEYWORD::LOST;
+}
+
+const char* CMessageParser::getSource() const
+{
+	return m_source == KEYWORD::RF ? "R" : "N";
+}
+
+void CMessageParser::onObjectStart(unsigned int depth, const char* key)
+{
+	// Only the first recognised top level object is of interest
+	if (depth != 1U || m_done || m_type != KEYWORD::UNKNOWN)
+		return;
+
+	KEYWORD type = findKeyword(key);
+	switch (type) {
+		case KEYWORD::MMDVM:
+		case KEYWORD::RSSI:
+		case KEYWORD::BER:
+		case KEYWORD::TEXT:
+		case KEYWORD::DSTAR:
+		case KEYWORD::DMR:
+		case KEYWORD::YSF:
+		case KEYWORD::P25:
+		case KEYWORD::NXDN:
+		case KEYWORD::POCSAG:
+		case KEYWORD::FM:
+			LogDebug("Identified as a message of type %s", key);
+			m_type = type;
+			break;
+		default:
+			break;
+	}
+}
+
+void CMessageParser::onObjectEnd(unsigned int depth)
+{
+	if (depth != 1U || m_done || m_type == KEYWORD::UNKNOWN)
+		return;
+
+	m_done = true;
+
+	switch (m_type) {
+		case KEYWORD::MMDVM:  m_result = buildMMDVM();  break;
+		case KEYWORD::RSSI:   m_result = buildRSSI();   break;
+		case KEYWORD::BER:    m_result = buildBER();    break;
+		case KEYWORD::TEXT:   m_result = buildText();   break;
+		case KEYWORD::DSTAR:  m_result = buildDStar();  break;
+		case KEYWORD::DMR:    m_result = buildDMR();    break;
+		case KEYWORD::YSF:    m_result = buildYSF();    break;
+		case KEYWORD::P25:    m_result = buildP25();    break;
+		case KEYWORD::NXDN:   m_result = buildNXDN();   break;
+		case KEYWORD::POCSAG: m_result = buildPOCSAG(); break;
+		case KEYWORD::FM:     m_result = buildFM();     break;
+		default:              break;
+	}
+}
+
+void CMessageParser::onValue(unsigned int depth, const char* key, JSON_TYPE type, const char* value)
+{
+	// Only the fields directly within the message object are wanted
+	if (depth != 2U || m_done || m_type == KEYWORD::UNKNOWN)
+		return;
+
+	KEYWORD field = findKeyword(key);
+
+	if (field == KEYWORD::VALUE) {
+		copyField(m_value, DISPLAY_EVENT_TEXT_LENGTH, value);
+		m_valueType = type;
+		m_fields |= FIELD_VALUE;
+		return;
+	}
+
+	if (type == JSON_TYPE::NUMBER) {
+		switch (field) {
+			case KEYWORD::SLOT:
+				m_slot = ::atoi(value);
+				m_fields |= FIELD_SLOT;
+				break;
+			case KEYWORD::DESTINATION_ID:
+				m_destinationId = ::atoi(value);
+				m_fields |= FIELD_DESTINATION_ID;
+				break;
+			case KEYWORD::DG_ID:
+				m_dgId = ::atoi(value);
+				m_fields |= FIELD_DG_ID;
+				break;
+			case KEYWORD::RIC:
+				m_ric = ::atoi(value);
+				m_fields |= FIELD_RIC;
+				break;
+			default:
+				break;
+		}
+		return;
+	}
+
+	if (type != JSON_TYPE::STRING)
+		return;
+
+	switch (field) {
+		case KEYWORD::MODE:
+			m_mode = findKeyword(value);
+			m_fields |= FIELD_MODE;
+			break;
+		case KEYWORD::ACTION:
+			m_action = findKeyword(value);
+			m_fields |= FIELD_ACTION;
+			break;
+		case KEYWORD::SOURCE:
+			m_source = findKeyword(value);
+			m_fields |= FIELD_SOURCE;
+			break;
+		case KEYWORD::DESTINATION_TYPE:
+			m_destinationType = findKeyword(value);
+			m_fields |= FIELD_DESTINATION_TYPE;
+			break;
+		case KEYWORD::FUNCTIONAL:
+			m_functional = findKeyword(value);
+			m_fields |= FIELD_FUNCTIONAL;
+			break;
+		case KEYWORD::STATE:
+			m_state = findKeyword(value);
+			copyField(m_stateText, DISPLAY_EVENT_FIELD_LENGTH, value);
+			m_fields |= FIELD_STATE;
+			break;
+		case KEYWORD::SOURCE_CS:
+			copyField(m_sourceCS, DISPLAY_EVENT_FIELD_LENGTH, value);
+			m_fields |= FIELD_SOURCE_CS;
+			break;
+		case KEYWORD::SOURCE_EXT:
+			copyField(m_sourceExt, DISPLAY_EVENT_FIELD_LENGTH, value);
+			m_fields |= FIELD_SOURCE_EXT;
+			break;
+		case KEYWORD::DESTINATION_CS:
+			copyField(m_destinationCS, DISPLAY_EVENT_FIELD_LENGTH, value);
+			m_fields |= FIELD_DESTINATION_CS;
+			break;
+		case KEYWORD::REFLECTOR:
+			copyField(m_reflector, DISPLAY_EVENT_FIELD_LENGTH, value);
+			m_fields |= FIELD_REFLECTOR;
+			break;
+		case KEYWORD::SOURCE_INFO:
+			copyField(m_sourceInfo, DISPLAY_EVENT_TEXT_LENGTH, value);
+			m_fields |= FIELD_SOURCE_INFO;
+			break;
+		case KEYWORD::MESSAGE:
+			copyField(m_message, DISPLAY_EVENT_TEXT_LENGTH, value);
+			m_fields |= FIELD_MESSAGE;
+			break;
+		default:
+			break;
+	}
+}
+
+bool CMessageParser::buildMMDVM()
+{
+	// We're only interested in the mode messages
+	if (!has(FIELD_MODE))
+		return false;
+
+	switch (m_mode) {
+		case KEYWORD::IDLE:
+			*m_event = CDisplayEvent(DISPLAY_EVENT::SET_IDLE);
+			return true;
+		case KEYWORD::CW:
+			*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_CW);
+			return true;
+		case KEYWORD::LOCKOUT:
+			*m_event = CDisplayEvent(DISPLAY_EVENT::SET_LOCKOUT);
+			return true;
+		case KEYWORD::ERROR_MODE:
+			*m_event = CDisplayEvent(DISPLAY_EVENT::SET_ERROR);
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool CMessageParser::buildRSSI()
+{
+	if (!has(FIELD_MODE | FIELD_VALUE) || m_valueType != JSON_TYPE::NUMBER)
+		return false;
+
+	DISPLAY_EVENT type;
+	switch (getKeywordMode(m_mode)) {
+		case MODE_DSTAR: type = DISPLAY_EVENT::WRITE_DSTAR_RSSI;  break;
+		case MODE_DMR:   type = DISPLAY_EVENT::WRITE_DMR_RSSI;    break;
+		case MODE_YSF:   type = DISPLAY_EVENT::WRITE_FUSION_RSSI; break;
+		case MODE_P25:   type = DISPLAY_EVENT::WRITE_P25_RSSI;    break;
+		case MODE_NXDN:  type = DISPLAY_EVENT::WRITE_NXDN_RSSI;   break;
+		case MODE_FM:    type = DISPLAY_EVENT::WRITE_FM_RSSI;     break;
+		default:         return false;
+	}
+
+	if (type == DISPLAY_EVENT::WRITE_DMR_RSSI && !has(FIELD_SLOT))
+		return false;
+
+	*m_event = CDisplayEvent(type);
+	m_event->m_slotNo = m_slot;
+	m_event->m_rssi   = ::atoi(m_value);
+
+	return true;
+}
+
+bool CMessageParser::buildBER()
+{
+	if (!has(FIELD_MODE | FIELD_VALUE) || m_valueType != JSON_TYPE::NUMBER)
+		return false;
+
+	DISPLAY_EVENT type;
+	switch (getKeywordMode(m_mode)) {
+		case MODE_DSTAR: type = DISPLAY_EVENT::WRITE_DSTAR_BER;  break;
+		case MODE_DMR:   type = DISPLAY_EVENT::WRITE_DMR_BER;    break;
+		case MODE_YSF:   type = DISPLAY_EVENT::WRITE_FUSION_BER; break;
+		case MODE_P25:   type = DISPLAY_EVENT::WRITE_P25_BER;    break;
+		case MODE_NXDN:  type = DISPLAY_EVENT::WRITE_NXDN_BER;   break;
+		default:         return false;
+	}
+
+	if (type == DISPLAY_EVENT::WRITE_DMR_BER && !has(FIELD_SLOT))
+		return false;
+
+	*m_event = CDisplayEvent(type);
+	m_event->m_slotNo = m_slot;
+	m_event->m_ber    = float(::atof(m_value));
+
+	return true;
+}
+
+bool CMessageParser::buildText()
+{
+	if (!has(FIELD_MODE | FIELD_VALUE) || m_valueType != JSON_TYPE::STRING)
+		return false;
+
+	switch (getKeywordMode(m_mode)) {
+		case MODE_DSTAR:
+			*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_DSTAR_TEXT);
+			break;
+		case MODE_DMR:
+			if (!has(FIELD_SLOT))
+				return false;
+			*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_DMR_TA);
+			m_event->m_slotNo = m_slot;
+			break;
+		default:
+			return false;
+	}
+
+	m_event->setText1(m_value);
+
+	return true;
+}
+
+bool CMessageParser::buildDStar()
+{
+	if (!has(FIELD_ACTION))
+		return false;
+
+	if (isStart()) {
+		if (!has(FIELD_SOURCE_CS | FIELD_SOURCE_EXT | FIELD_DESTINATION_CS | FIELD_SOURCE))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_DSTAR);
+		m_event->setText1(m_sourceCS);
+		m_event->setText2(m_sourceExt);
+		m_event->setText3(m_destinationCS);
+		m_event->setText4(has(FIELD_REFLECTOR) ? m_reflector : "");
+		m_event->setType(getSource());
+	} else if (isEnd()) {
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_DSTAR);
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+bool CMessageParser::buildDMR()
+{
+	if (!has(FIELD_ACTION))
+		return false;
+
+	if (isStart()) {
+		if (!has(FIELD_SLOT | FIELD_DESTINATION_ID | FIELD_DESTINATION_TYPE | FIELD_SOURCE))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_DMR);
+		m_event->m_slotNo = m_slot;
+		m_event->m_group  = m_destinationType == KEYWORD::GROUP;
+		m_event->m_number = m_destinationId;
+		m_event->setText1(has(FIELD_SOURCE_INFO) ? m_sourceInfo : "");
+		m_event->setType(getSource());
+	} else if (isEnd()) {
+		if (!has(FIELD_SLOT))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_DMR);
+		m_event->m_slotNo = m_slot;
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+bool CMessageParser::buildYSF()
+{
+	if (!has(FIELD_ACTION))
+		return false;
+
+	if (isStart()) {
+		if (!has(FIELD_SOURCE_CS | FIELD_DG_ID | FIELD_SOURCE))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_FUSION);
+		m_event->m_number = m_dgId;
+		m_event->setText1(m_sourceCS);
+		m_event->setText2("ALL");
+		m_event->setText4(has(FIELD_REFLECTOR) ? m_reflector : "");
+		m_event->setType(getSource());
+	} else if (isEnd()) {
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_FUSION);
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+bool CMessageParser::buildP25()
+{
+	if (!has(FIELD_ACTION))
+		return false;
+
+	if (isStart()) {
+		if (!has(FIELD_DESTINATION_ID | FIELD_DESTINATION_TYPE | FIELD_SOURCE))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_P25);
+		m_event->m_group  = m_destinationType == KEYWORD::GROUP;
+		m_event->m_number = m_destinationId;
+		m_event->setText1(has(FIELD_SOURCE_INFO) ? m_sourceInfo : "");
+		m_event->setType(getSource());
+	} else if (isEnd()) {
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_P25);
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+bool CMessageParser::buildNXDN()
+{
+	if (!has(FIELD_ACTION))
+		return false;
+
+	if (isStart()) {
+		if (!has(FIELD_DESTINATION_ID | FIELD_DESTINATION_TYPE | FIELD_SOURCE))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_NXDN);
+		m_event->m_group  = m_destinationType == KEYWORD::GROUP;
+		m_event->m_number = m_destinationId;
+		m_event->setText1(has(FIELD_SOURCE_INFO) ? m_sourceInfo : "");
+		m_event->setType(getSource());
+	} else if (isEnd()) {
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_NXDN);
+	} else {
+		return false;
+	}
+
+	return true;
+}
+
+bool CMessageParser::buildPOCSAG()
+{
+	if (!has(FIELD_FUNCTIONAL))
+		return false;
+
+	if (m_functional == KEYWORD::END) {
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_POCSAG);
+	} else {
+		if (!has(FIELD_RIC))
+			return false;
+
+		*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_POCSAG);
+		m_event->m_number = m_ric;
+		m_event->setText1(has(FIELD_MESSAGE) ? m_message : "");
+	}
+
+	return true;
+}
+
+bool CMessageParser::buildFM()
+{
+	if (!has(FIELD_STATE))
+		return false;
+
+	if (m_state == KEYWORD::LISTENING) {
+		*m_event = CDisplayEvent(DISPLAY_EVENT::CLEAR_FM);
+		return true;
+	}
+
+	*m_event = CDisplayEvent(DISPLAY_EVENT::WRITE_FM);
+
+	switch (m_state) {
+		case KEYWORD::KERCHUNK_RF:
+			m_event->setText1("R: Kerchunk");
+			break;
+		case KEYWORD::RELAYING_RF:
+			m_event->setText1("R: Relaying");
+			break;
+		case KEYWORD::RELAYING_WAIT_RF:
+		case KEYWORD::TIMEOUT_WAIT_RF:
+		case KEYWORD::HANG:
+			m_event->setText1("R: Wait");
+			break;
+		case KEYWORD::TIMEOUT_RF:
+			m_event->setText1("R: Timeout");
+			break;
+		case KEYWORD::KERCHUNK_EXT:
+			m_event->setText1("N: Kerchunk");
+			break;
+		case KEYWORD::RELAYING_EXT:
+			m_event->setText1("N: Relaying");
+			break;
+		case KEYWORD::RELAYING_WAIT_EXT:
+		case KEYWORD::TIMEOUT_WAIT_EXT:
+			m_event->setText1("N: Wait");
+			break;
+		case KEYWORD::TIMEOUT_EXT:
+			m_event->setText1("N: Timeout");
+			break;
+		default:
+			m_event->setText1(m_stateText);
+			break;
+	}
+
+	return true;
+}
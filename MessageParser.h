@@ -0,0 +1,85 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(MESSAGEPARSER_H)
+#define	MESSAGEPARSER_H
+
+#include "DisplayEvent.h"
+#include "JSONParser.h"
+#include "Keywords.h"
+
+// Turns one MMDVMHost JSON message into at most one display event, only
+// the fields needed are kept and no memory is allocated.
+class CMessageParser : public IJSONHandler {
+public:
+	CMessageParser();
+	virtual ~CMessageParser();
+
+	// Returns true if the message results in a display event
+	bool parse(const char* text, unsigned int length, CDisplayEvent& event);
+
+	virtual void onObjectStart(unsigned int depth, const char* key);
+	virtual void onObjectEnd(unsigned int depth);
+	virtual void onValue(unsigned int depth, const char* key, JSON_TYPE type, const char* value);
+
+private:
+	CJSONParser    m_parser;
+	CDisplayEvent* m_event;
+	KEYWORD        m_type;
+	bool           m_done;
+	bool           m_result;
+	unsigned int   m_fields;
+	KEYWORD        m_mode;
+	KEYWORD        m_action;
+	KEYWORD        m_source;
+	KEYWORD        m_destinationType;
+	KEYWORD        m_functional;
+	KEYWORD        m_state;
+	char           m_sourceCS[DISPLAY_EVENT_FIELD_LENGTH];
+	char           m_sourceExt[DISPLAY_EVENT_FIELD_LENGTH];
+	char           m_destinationCS[DISPLAY_EVENT_FIELD_LENGTH];
+	char           m_reflector[DISPLAY_EVENT_FIELD_LENGTH];
+	char           m_stateText[DISPLAY_EVENT_FIELD_LENGTH];
+	char           m_sourceInfo[DISPLAY_EVENT_TEXT_LENGTH];
+	char           m_message[DISPLAY_EVENT_TEXT_LENGTH];
+	char           m_value[DISPLAY_EVENT_TEXT_LENGTH];
+	JSON_TYPE      m_valueType;
+	int            m_slot;
+	int            m_destinationId;
+	int            m_dgId;
+	int            m_ric;
+
+	bool has(unsigned int fields) const;
+	bool isStart() const;
+	bool isEnd() const;
+	const char* getSource() const;
+
+	bool buildMMDVM();
+	bool buildRSSI();
+	bool buildBER();
+	bool buildText();
+	bool buildDStar();
+	bool buildDMR();
+	bool buildYSF();
+	bool buildP25();
+	bool buildNXDN();
+	bool buildPOCSAG();
+	bool buildFM();
+};
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Metrics.h"
+#include "Utils.h"
+#include "Log.h"
+
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+
+// Timings are kept in power of two buckets, the last catches everything longer
+const unsigned int TIME_BUCKETS = 24U;
+
+static const char* COUNT_NAMES[] = {"json_messages", "display_messages", "uart_bytes", "modem_bytes", "modem_publishes", "mqtt_dropped", "nextion_suppressed", "nextion_coalesced", "nextion_shed"};
+static const char* LEVEL_NAMES[] = {"nextion_output", "modem_buffer", "mqtt_outbound"};
+static const char* TIME_NAMES[]  = {"parse_us", "nextion_ack_us", "main_loop_us"};
+
+const unsigned int COUNT_COUNT = sizeof(COUNT_NAMES) / sizeof(COUNT_NAMES[0U]);
+const unsigned int LEVEL_COUNT = sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0U]);
+const unsigned int TIME_COUNT  = sizeof(TIME_NAMES) / sizeof(TIME_NAMES[0U]);
+
+struct CLevel {
+	std::atomic<unsigned int> m_current;
+	std::atomic<unsigned int> m_max;
+};
+
+struct CTiming {
+	std::atomic<unsigned long long> m_count;
+	std::atomic<unsigned long long> m_sum;
+	std::atomic<unsigned long long> m_max;
+	std::atomic<unsigned long long> m_buckets[TIME_BUCKETS];
+};
+
+static bool m_enabled = false;
+
+static std::atomic<unsigned long long> m_counts[COUNT_COUNT];
+static CLevel  m_levels[LEVEL_COUNT];
+static CTiming m_times[TIME_COUNT];
+
+static void updateMax(std::atomic<unsigned long long>& max, unsigned long long value)
+{
+	unsigned long long current = max.load(std::memory_order_relaxed);
+	while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		;
+}
+
+static void updateMax(std::atomic<unsigned int>& max, unsigned int value)
+{
+	unsigned int current = max.load(std::memory_order_relaxed);
+	while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		;
+}
+
+void MetricsInitialise(bool enabled)
+{
+	for (unsigned int i = 0U; i < COUNT_COUNT; i++)
+		m_counts[i] = 0ULL;
+
+	for (unsigned int i = 0U; i < LEVEL_COUNT; i++) {
+		m_levels[i].m_current = 0U;
+		m_levels[i].m_max     = 0U;
+	}
+
+	for (unsigned int i = 0U; i < TIME_COUNT; i++) {
+		m_times[i].m_count = 0ULL;
+		m_times[i].m_sum   = 0ULL;
+		m_times[i].m_max   = 0ULL;
+		for (unsigned int j = 0U; j < TIME_BUCKETS; j++)
+			m_times[i].m_buckets[j] = 0ULL;
+	}
+
+	m_enabled = enabled;
+}
+
+void MetricsCount(METRIC_COUNT count, unsigned int n)
+{
+	if (!m_enabled)
+		return;
+
+	m_counts[int(count)].fetch_add(n, std::memory_order_relaxed);
+}
+
+void MetricsLevel(METRIC_LEVEL level, unsigned int& reported, unsigned int value)
+{
+	if (!m_enabled)
+		return;
+
+	CLevel& l = m_levels[int(level)];
+
+	// The difference wraps when the share shrinks, which still sums correctly
+	unsigned int change = value - reported;
+	reported = value;
+
+	unsigned int total = l.m_current.fetch_add(change, std::memory_order_relaxed) + change;
+	updateMax(l.m_max, total);
+}
+
+void MetricsTime(METRIC_TIME time, unsigned long long us)
+{
+	if (!m_enabled)
+		return;
+
+	CTiming& t = m_times[int(time)];
+
+	unsigned int bucket = 0U;
+	for (unsigned long long n = us; n > 0ULL && bucket < (TIME_BUCKETS - 1U); n >>= 1)
+		bucket++;
+
+	t.m_count.fetch_add(1ULL, std::memory_order_relaxed);
+	t.m_sum.fetch_add(us, std::memory_order_relaxed);
+	t.m_buckets[bucket].fetch_add(1ULL, std::memory_order_relaxed);
+	updateMax(t.m_max, us);
+}
+
+unsigned long long MetricsNow()
+{
+	if (!m_enabled)
+		return 0ULL;
+
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void writePrometheus(const std::string& file)
+{
+	// Write alongside and rename, so that a scrape never sees half a file
+	std::string temp = file + ".tmp";
+
+	FILE* fp = ::fopen(temp.c_str(), "wt");
+	if (fp == nullptr) {
+		LogWarning("Unable to open the metrics file %s", temp.c_str());
+		return;
+	}
+
+	for (unsigned int i = 0U; i < COUNT_COUNT; i++) {
+		::fprintf(fp, "# TYPE displaydriver_%s_total counter\n", COUNT_NAMES[i]);
+		::fprintf(fp, "displaydriver_%s_total %llu\n", COUNT_NAMES[i], m_counts[i].load());
+	}
+
+	for (unsigned int i = 0U; i < LEVEL_COUNT; i++) {
+		::fprintf(fp, "# TYPE displaydriver_%s gauge\n", LEVEL_NAMES[i]);
+		::fprintf(fp, "displaydriver_%s %u\n", LEVEL_NAMES[i], m_levels[i].m_current.load());
+		::fprintf(fp, "# TYPE displaydriver_%s_max gauge\n", LEVEL_NAMES[i]);
+		::fprintf(fp, "displaydriver_%s_max %u\n", LEVEL_NAMES[i], m_levels[i].m_max.load());
+	}
+
+	for (unsigned int i = 0U; i < TIME_COUNT; i++) {
+		const CTiming& t = m_times[i];
+
+		::fprintf(fp, "# TYPE displaydriver_%s histogram\n", TIME_NAMES[i]);
+
+		unsigned long long total = 0ULL;
+		for (unsigned int j = 0U; j < (TIME_BUCKETS - 1U); j++) {
+			total += t.m_buckets[j].load();
+			::fprintf(fp, "displaydriver_%s_bucket{le=\"%llu\"} %llu\n", TIME_NAMES[i], (1ULL << j) - 1ULL, total);
+		}
+
+		total += t.m_buckets[TIME_BUCKETS - 1U].load();
+		::fprintf(fp, "displaydriver_%s_bucket{le=\"+Inf\"} %llu\n", TIME_NAMES[i], total);
+		::fprintf(fp, "displaydriver_%s_sum %llu\n", TIME_NAMES[i], t.m_sum.load());
+		::fprintf(fp, "displaydriver_%s_count %llu\n", TIME_NAMES[i], total);
+	}
+
+	::fclose(fp);
+
+	if (::rename(temp.c_str(), file.c_str()) != 0)
+		LogWarning("Unable to rename the metrics file to %s", file.c_str());
+}
+
+void MetricsWrite(const std::string& prometheusFile)
+{
+	if (!m_enabled)
+		return;
+
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+
+	for (unsigned int i = 0U; i < COUNT_COUNT; i++)
+		json[COUNT_NAMES[i]] = m_counts[i].load();
+
+	for (unsigned int i = 0U; i < LEVEL_COUNT; i++) {
+		nlohmann::json level;
+
+		level["current"] = m_levels[i].m_current.load();
+		level["max"]     = m_levels[i].m_max.load();
+
+		json[LEVEL_NAMES[i]] = level;
+	}
+
+	for (unsigned int i = 0U; i < TIME_COUNT; i++) {
+		const CTiming& t = m_times[i];
+
+		nlohmann::json timing;
+
+		unsigned long long count = t.m_count.load();
+
+		timing["count"] = count;
+		timing["mean"]  = count > 0ULL ? t.m_sum.load() / count : 0ULL;
+		timing["max"]   = t.m_max.load();
+
+		// Bucket n holds the times that need n bits, trailing empty buckets are left off
+		unsigned int last = 0U;
+		for (unsigned int j = 0U; j < TIME_BUCKETS; j++) {
+			if (t.m_buckets[j].load() > 0ULL)
+				last = j + 1U;
+		}
+
+		nlohmann::json buckets = nlohmann::json::array();
+		for (unsigned int j = 0U; j < last; j++)
+			buckets.push_back(t.m_buckets[j].load());
+		timing["buckets"] = buckets;
+
+		json[TIME_NAMES[i]] = timing;
+	}
+
+	WriteJSON("metrics", json);
+
+	if (!prometheusFile.empty())
+		writePrometheus(prometheusFile);
+}
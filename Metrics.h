@@ -0,0 +1,66 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(METRICS_H)
+#define	METRICS_H
+
+#include <string>
+
+enum class METRIC_COUNT {
+	JSON_MESSAGES,
+	DISPLAY_MESSAGES,
+	UART_BYTES,
+	MODEM_BYTES,
+	MODEM_PUBLISHES,
+	MQTT_DROPPED,
+	NEXTION_SUPPRESSED,
+	NEXTION_COALESCED,
+	NEXTION_SHED
+};
+
+enum class METRIC_LEVEL {
+	NEXTION_OUTPUT,
+	MODEM_BUFFER,
+	MQTT_OUTBOUND
+};
+
+enum class METRIC_TIME {
+	PARSE,
+	NEXTION_ACK,
+	MAIN_LOOP
+};
+
+// Counters, queue levels and timings in microseconds. Everything is a
+// no-op until MetricsInitialise() has been called with enabled set.
+extern void MetricsInitialise(bool enabled);
+
+// The counts are totals over every instance, display and port
+extern void MetricsCount(METRIC_COUNT count, unsigned int n = 1U);
+
+// A level is the sum over everything reporting it, such as one Nextion
+// per display, so each reporter passes in the share it last reported
+extern void MetricsLevel(METRIC_LEVEL level, unsigned int& reported, unsigned int value);
+extern void MetricsTime(METRIC_TIME time, unsigned long long us);
+
+// Returns 0 when disabled, so that timing costs nothing either
+extern unsigned long long MetricsNow();
+
+// Publishes under the "metrics" key, and optionally to a Prometheus text file
+extern void MetricsWrite(const std::string& prometheusFile);
+
+#endif
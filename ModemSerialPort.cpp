@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2016,2020,2021,2023,2025 by Jonathan Naylor G4KLX
+*   Copyright (C) 2016,2020,2021,2023,2025,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 
 #include "ModemSerialPort.h"
 #include "MQTTConnection.h"
+#include "Metrics.h"
 
 #include <cstdio>
 #include <cassert>
@@ -25,11 +26,22 @@
 // In Log.cpp
 extern CMQTTConnection* m_mqtt;
 
+// Output is published once it reaches this many bytes
+const unsigned int PUBLISH_LENGTH = 250U;
+
+// The longest that output is held back for more to join it, in ms
+const unsigned int LINGER_TIME = 2U;
+
 CModemSerialPort::CModemSerialPort(const std::string& mmdvmName) :
 m_serialName(),
-m_buffer(500U, "Modem serial")
+m_buffer(500U, "Modem serial"),
+m_output(),
+m_linger(),
+m_bufferLevel(0U)
 {
 	m_serialName = mmdvmName + "/display-in";
+
+	m_output.reserve(PUBLISH_LENGTH * 2U);
 }
 
 CModemSerialPort::~CModemSerialPort()
@@ -45,20 +57,55 @@ int CModemSerialPort::write(const unsigned char* data, unsigned int length)
 {
 	assert(data != nullptr);
 	assert(length > 0U);
-	assert(m_mqtt != nullptr);
 
-	m_mqtt->publish(m_serialName.c_str(), data, length);
+	// Each publish is a QoS 2 exchange with the broker, so writes are
+	// gathered into one until there are enough of them, they have waited
+	// long enough, or the display flushes at the end of its pass
+	if (m_output.empty())
+		m_linger.start();
+
+	m_output.insert(m_output.end(), data, data + length);
+
+	::MetricsCount(METRIC_COUNT::MODEM_BYTES, length);
+
+	if (m_output.size() >= PUBLISH_LENGTH || m_linger.elapsed() >= LINGER_TIME)
+		flush();
 
 	return length;
 }
 
+bool CModemSerialPort::flush()
+{
+	if (m_output.empty())
+		return true;
+
+	// There is no broker when replaying a capture
+	if (m_mqtt != nullptr)
+		m_mqtt->publish(m_serialName.c_str(), m_output.data(), (unsigned int)m_output.size());
+
+	::MetricsCount(METRIC_COUNT::MODEM_PUBLISHES);
+
+	m_output.clear();
+
+	return true;
+}
+
+bool CModemSerialPort::drain()
+{
+	return flush();
+}
+
+bool CModemSerialPort::wantWrite() const
+{
+	return !m_output.empty();
+}
+
 int CModemSerialPort::read(unsigned char* data, unsigned int length)
 {
 	assert(data != nullptr);
 	assert(length > 0U);
 
 	unsigned int len = m_buffer.dataSize();
-
 	if (len == 0U)
 		return 0;
 
@@ -70,8 +117,17 @@ int CModemSerialPort::read(unsigned char* data, unsigned int length)
 	return length;
 }
 
+int CModemSerialPort::readAvailable(unsigned char* data, unsigned int length)
+{
+	// Reads never wait here
+	return read(data, length);
+}
+
 void CModemSerialPort::close()
 {
+	flush();
+
+	::MetricsLevel(METRIC_LEVEL::MODEM_BUFFER, m_bufferLevel, 0U);
 }
 
 void CModemSerialPort::readData(const unsigned char* data, unsigned int length)
@@ -79,6 +135,9 @@ void CModemSerialPort::readData(const unsigned char* data, unsigned int length)
 	assert(data != nullptr);
 	assert(length > 0U);
 
+	// Filled from the MQTT callback and emptied by the display
 	m_buffer.addData(data, length);
+
+	::MetricsLevel(METRIC_LEVEL::MODEM_BUFFER, m_bufferLevel, m_buffer.dataSize());
 }
 
@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2016,2020,2021,2023 by Jonathan Naylor G4KLX
+*   Copyright (C) 2016,2020,2021,2023,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -21,8 +21,10 @@
 
 #include "SerialPort.h"
 #include "RingBuffer.h"
+#include "StopWatch.h"
 
 #include <string>
+#include <vector>
 
 class CModemSerialPort : public ISerialPort {
 public:
@@ -33,8 +35,16 @@ public:
 
 	virtual int read(unsigned char* buffer, unsigned int length);
 
+	virtual int readAvailable(unsigned char* buffer, unsigned int length);
+
 	virtual int write(const unsigned char* buffer, unsigned int length);
 
+	virtual bool flush();
+
+	virtual bool drain();
+
+	virtual bool wantWrite() const;
+
 	virtual void close();
 
 	void readData(const unsigned char* data, unsigned int length);
@@ -42,6 +52,9 @@ public:
 private:
 	std::string                m_serialName;
 	CRingBuffer<unsigned char> m_buffer;
+	std::vector<unsigned char> m_output;
+	CStopWatch                 m_linger;
+	unsigned int               m_bufferLevel;
 };
 
 #endif
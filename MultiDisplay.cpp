@@ -0,0 +1,390 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "MultiDisplay.h"
+#include "Log.h"
+
+#include <cassert>
+
+CMultiDisplay::CMultiDisplay(unsigned int length) :
+CDisplay(),
+m_length(length),
+m_children()
+{
+	assert(length > 0U);
+}
+
+CMultiDisplay::~CMultiDisplay()
+{
+	for (auto& it : m_children) {
+		delete it.m_thread;
+		delete it.m_coalescer;
+		delete it.m_display;
+	}
+}
+
+void CMultiDisplay::add(CDisplay* display, unsigned int interval)
+{
+	assert(display != nullptr);
+
+	CChild child;
+	child.m_display   = display;
+	child.m_thread    = nullptr;
+	child.m_coalescer = (interval > 0U) ? new CDisplayCoalescer(m_timers, interval) : nullptr;
+
+	m_children.push_back(child);
+}
+
+bool CMultiDisplay::open()
+{
+	for (unsigned int i = 0U; i < m_children.size(); i++) {
+		CChild& child = m_children.at(i);
+
+		bool ret = child.m_display->open();
+		if (ret) {
+			child.m_thread = new CDisplayThread(child.m_display, m_length);
+
+			ret = child.m_thread->start();
+			if (!ret) {
+				LogError("Unable to start the display thread");
+				delete child.m_thread;
+				child.m_thread = nullptr;
+
+				child.m_display->close();
+			}
+		}
+
+		if (!ret) {
+			// Undo the ones that have already been opened
+			while (i > 0U) {
+				CChild& opened = m_children.at(--i);
+
+				opened.m_thread->stop();
+				delete opened.m_thread;
+				opened.m_thread = nullptr;
+
+				opened.m_display->close();
+			}
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CMultiDisplay::close()
+{
+	for (auto& it : m_children) {
+		if (it.m_thread != nullptr) {
+			it.m_thread->stop();
+			delete it.m_thread;
+			it.m_thread = nullptr;
+		}
+
+		it.m_display->close();
+	}
+}
+
+void CMultiDisplay::setIdleInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::SET_IDLE);
+	post(event);
+}
+
+void CMultiDisplay::setErrorInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::SET_ERROR);
+	post(event);
+}
+
+void CMultiDisplay::setLockoutInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::SET_LOCKOUT);
+	post(event);
+}
+
+void CMultiDisplay::setQuitInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::SET_QUIT);
+	post(event);
+}
+
+void CMultiDisplay::writeDStarInt(const std::string& my1, const std::string& my2, const std::string& your, const std::string& type, const std::string& reflector)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DSTAR);
+	event.setText1(my1.c_str());
+	event.setText2(my2.c_str());
+	event.setText3(your.c_str());
+	event.setType(type.c_str());
+	event.setText4(reflector.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeDStarRSSIInt(int rssi)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DSTAR_RSSI);
+	event.m_rssi = rssi;
+	post(event);
+}
+
+void CMultiDisplay::writeDStarBERInt(float ber)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DSTAR_BER);
+	event.m_ber = ber;
+	post(event);
+}
+
+void CMultiDisplay::writeDStarTextInt(const std::string& text)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DSTAR_TEXT);
+	event.setText1(text.c_str());
+	post(event);
+}
+
+void CMultiDisplay::clearDStarInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_DSTAR);
+	post(event);
+}
+
+void CMultiDisplay::writeDMRInt(unsigned int slotNo, const std::string& src, bool group, unsigned int dst, const std::string& type)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DMR);
+	event.m_slotNo = slotNo;
+	event.setText1(src.c_str());
+	event.m_group  = group;
+	event.m_number = dst;
+	event.setType(type.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeDMRRSSIInt(unsigned int slotNo, int rssi)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DMR_RSSI);
+	event.m_slotNo = slotNo;
+	event.m_rssi   = rssi;
+	post(event);
+}
+
+void CMultiDisplay::writeDMRTAInt(unsigned int slotNo, const std::string& talkerAlias)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DMR_TA);
+	event.m_slotNo = slotNo;
+	event.setText1(talkerAlias.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeDMRBERInt(unsigned int slotNo, float ber)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_DMR_BER);
+	event.m_slotNo = slotNo;
+	event.m_ber    = ber;
+	post(event);
+}
+
+void CMultiDisplay::clearDMRInt(unsigned int slotNo)
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_DMR);
+	event.m_slotNo = slotNo;
+	post(event);
+}
+
+void CMultiDisplay::writeFusionInt(const std::string& source, const std::string& dest, unsigned char dgid, const std::string& type, const std::string& origin)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_FUSION);
+	event.setText1(source.c_str());
+	event.setText2(dest.c_str());
+	event.m_number = dgid;
+	event.setType(type.c_str());
+	event.setText4(origin.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeFusionRSSIInt(int rssi)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_FUSION_RSSI);
+	event.m_rssi = rssi;
+	post(event);
+}
+
+void CMultiDisplay::writeFusionBERInt(float ber)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_FUSION_BER);
+	event.m_ber = ber;
+	post(event);
+}
+
+void CMultiDisplay::clearFusionInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_FUSION);
+	post(event);
+}
+
+void CMultiDisplay::writeP25Int(const std::string& source, bool group, unsigned int dest, const std::string& type)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_P25);
+	event.setText1(source.c_str());
+	event.m_group  = group;
+	event.m_number = dest;
+	event.setType(type.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeP25RSSIInt(int rssi)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_P25_RSSI);
+	event.m_rssi = rssi;
+	post(event);
+}
+
+void CMultiDisplay::writeP25BERInt(float ber)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_P25_BER);
+	event.m_ber = ber;
+	post(event);
+}
+
+void CMultiDisplay::clearP25Int()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_P25);
+	post(event);
+}
+
+void CMultiDisplay::writeNXDNInt(const std::string& source, bool group, unsigned int dest, const std::string& type)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_NXDN);
+	event.setText1(source.c_str());
+	event.m_group  = group;
+	event.m_number = dest;
+	event.setType(type.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeNXDNRSSIInt(int rssi)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_NXDN_RSSI);
+	event.m_rssi = rssi;
+	post(event);
+}
+
+void CMultiDisplay::writeNXDNBERInt(float ber)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_NXDN_BER);
+	event.m_ber = ber;
+	post(event);
+}
+
+void CMultiDisplay::clearNXDNInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_NXDN);
+	post(event);
+}
+
+void CMultiDisplay::writePOCSAGInt(uint32_t ric, const std::string& message)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_POCSAG);
+	event.m_number = ric;
+	event.setText1(message.c_str());
+	post(event);
+}
+
+void CMultiDisplay::clearPOCSAGInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_POCSAG);
+	post(event);
+}
+
+void CMultiDisplay::writeFMInt(const std::string& state)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_FM);
+	event.setText1(state.c_str());
+	post(event);
+}
+
+void CMultiDisplay::writeFMRSSIInt(int rssi)
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_FM_RSSI);
+	event.m_rssi = rssi;
+	post(event);
+}
+
+void CMultiDisplay::clearFMInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_FM);
+	post(event);
+}
+
+void CMultiDisplay::writeCWInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::WRITE_CW);
+	post(event);
+}
+
+void CMultiDisplay::clearCWInt()
+{
+	CDisplayEvent event(DISPLAY_EVENT::CLEAR_CW);
+	post(event);
+}
+
+void CMultiDisplay::clockInt()
+{
+	// The displays are clocked by their own threads, only the held back
+	// telemetry and the events waiting for room in their queues are ours
+	for (auto& it : m_children) {
+		if (it.m_thread != nullptr)
+			it.m_thread->flush();
+
+		if (it.m_coalescer == nullptr)
+			continue;
+
+		CDisplayEvent event;
+		while (it.m_coalescer->get(event))
+			post(it, event);
+	}
+}
+
+unsigned int CMultiDisplay::getTimeoutInt()
+{
+	for (const auto& it : m_children) {
+		if (it.m_thread != nullptr && it.m_thread->hasBacklog())
+			return BACKLOG_RETRY;
+	}
+
+	return CDisplay::getTimeoutInt();
+}
+
+void CMultiDisplay::post(CDisplayEvent& event)
+{
+	event.m_direct = true;
+
+	for (auto& it : m_children) {
+		if (it.m_coalescer != nullptr && it.m_coalescer->add(event))
+			continue;
+
+		post(it, event);
+	}
+}
+
+void CMultiDisplay::post(CChild& child, const CDisplayEvent& event)
+{
+	// A full queue only holds up this display
+	if (child.m_thread != nullptr)
+		child.m_thread->post(event);
+}
@@ -18,6 +18,7 @@
 
 #include "NetworkInfo.h"
 #include "Nextion.h"
+#include "Metrics.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -37,9 +38,30 @@
 // 00:low, others:high-speed. bit[2] is overlapped with LAYOUT_COMPAT_MASK.
 #define LAYOUT_HIGHSPEED	(3 << 2)
 
-const unsigned int MAX_REPLY_LENGTH = 9U;
+// The most bytes taken from the port at a time
+const unsigned int READ_LENGTH = 64U;
 
-CNextion::CNextion(const std::string& callsign, unsigned int id, bool duplex, ISerialPort* serial, unsigned int brightness, bool displayClock, bool utc, unsigned int idleBrightness, unsigned int screenLayout, bool displayTempInF) :
+// The most commands that may be awaiting a reply, a power of two
+const unsigned int MAX_WINDOW = 16U;
+
+// The most commands waiting to be sent
+const unsigned int QUEUE_LENGTH = 100U;
+
+// The rates the link may be raised to, fastest first
+const unsigned int RAISED_SPEEDS[] = {921600U, 460800U, 230400U};
+const unsigned int RAISED_SPEEDS_COUNT = sizeof(RAISED_SPEEDS) / sizeof(unsigned int);
+
+// The rates the display may be found at, fastest first
+const unsigned int PROBE_SPEEDS[] = {921600U, 460800U, 230400U, 115200U, 9600U};
+const unsigned int PROBE_SPEEDS_COUNT = sizeof(PROBE_SPEEDS) / sizeof(unsigned int);
+
+// How long to wait for the answer to a probe, in ms
+const unsigned int PROBE_TIME = 250U;
+
+// How long the display takes to change its rate, in ms
+const unsigned int SETTLE_TIME = 50U;
+
+CNextion::CNextion(const std::string& callsign, unsigned int id, bool duplex, ISerialPort* serial, unsigned int brightness, bool displayClock, bool utc, unsigned int idleBrightness, unsigned int screenLayout, bool displayTempInF, unsigned int window, unsigned int baudrate) :
 CDisplay(),
 m_callsign(callsign),
 m_id(id),
@@ -52,17 +74,32 @@ m_displayClock(displayClock),
 m_utc(utc),
 m_idleBrightness(idleBrightness),
 m_screenLayout(0),
-m_clockDisplayTimer(1000U, 0U, 400U),
+m_clockDisplayTimer(m_timers, 400U, [this]() { updateClock(); }),
 m_displayTempInF(displayTempInF),
-m_output(2000U, "Nextion buffer"),
-m_mutex(),
-m_reply(nullptr),
-m_waiting(false),
-m_waitingTimer(1000U, 0U, 500U)
+m_output(QUEUE_LENGTH),
+m_decoder(),
+m_window(window),
+m_baudrate(baudrate),
+m_sendPtr(0U),
+m_ackPtr(0U),
+m_recovery(0U),
+m_waitingTimer(m_timers, 500U, [this]() { responseTimeout(); }),
+m_sent(nullptr),
+m_outputLevel(0U),
+m_shadow()
 {
 	assert(serial != nullptr);
 	assert(brightness >= 0U && brightness <= 100U);
 
+	if (m_window == 0U)
+		m_window = 1U;
+	else if (m_window > MAX_WINDOW)
+		m_window = MAX_WINDOW;
+
+	// bkcmd=3 is not yet in force for the first commands, so start with
+	// stop and wait
+	m_recovery = m_window;
+
 	static const unsigned int feature_set[] = {
 		0,				// 0: G4KLX
 		0,				// 1: (reserved, low speed)
@@ -80,12 +117,12 @@ m_waitingTimer(1000U, 0U, 500U)
 	else
 		m_screenLayout = feature_set[screenLayout];
 
-	m_reply = new unsigned char[MAX_REPLY_LENGTH];
+	m_sent = new unsigned long long[MAX_WINDOW];
 }
 
 CNextion::~CNextion()
 {
-	delete[] m_reply;
+	delete[] m_sent;
 }
 
 bool CNextion::open()
@@ -100,13 +137,15 @@ bool CNextion::open()
 		return false;
 	}
 
+	negotiate();
+
 	info[0] = 0;
 	m_network = new CNetworkInfo;
 	m_network->getNetworkInterface(info);
 	m_ipAddress = (char*)info;
 
-	sendCommand("bkcmd=3");
-	sendCommandAction(0U);
+	sendCommand("bkcmd=3", NEXTION_PRIORITY::STATE);
+	sendCommandAction(0U, NEXTION_PRIORITY::STATE);
 
 	setIdle();
 
@@ -118,12 +157,12 @@ void CNextion::setIdleInt()
 	// a few bits borrowed from Lieven De Samblanx ON7LDS, NextionDriver
 	char command[100U];
 
-	sendCommand("page MMDVM");
-	sendCommandAction(1U);
+	sendCommand("page MMDVM", NEXTION_PRIORITY::STATE);
+	sendCommandAction(1U, NEXTION_PRIORITY::STATE);
 
 	if (m_brightness > 0U) {
 		::sprintf(command, "dim=%u", m_idleBrightness);
-		sendCommand(command);
+		sendCommand(command, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(command, "t0.txt=\"%s/%u\"", m_callsign.c_str(), m_id);
@@ -151,8 +190,8 @@ void CNextion::setIdleInt()
 				} else {	
 					::sprintf(command, "t20.txt=\"%2.1f %cC\"", val, 176);
 				}
-				sendCommand(command);
-				sendCommandAction(22U);
+				sendCommand(command, NEXTION_PRIORITY::TELEMETRY);
+				sendCommandAction(22U, NEXTION_PRIORITY::TELEMETRY);
 			}
 		}
 	} else {
@@ -173,13 +212,13 @@ void CNextion::setIdleInt()
 
 void CNextion::setErrorInt()
 {
-	sendCommand("page MMDVM");
-	sendCommandAction(1U);
+	sendCommand("page MMDVM", NEXTION_PRIORITY::STATE);
+	sendCommandAction(1U, NEXTION_PRIORITY::STATE);
 
 	char command[20];
 	if (m_brightness>0) {
 		::sprintf(command, "dim=%u", m_brightness);
-		sendCommand(command);
+		sendCommand(command, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(command, "t0.txt=\"ERROR\"");
@@ -192,13 +231,13 @@ void CNextion::setErrorInt()
 
 void CNextion::setLockoutInt()
 {
-	sendCommand("page MMDVM");
-	sendCommandAction(1U);
+	sendCommand("page MMDVM", NEXTION_PRIORITY::STATE);
+	sendCommandAction(1U, NEXTION_PRIORITY::STATE);
 
 	char command[20];
 	if (m_brightness>0) {
 		::sprintf(command, "dim=%u", m_brightness);
-		sendCommand(command);
+		sendCommand(command, NEXTION_PRIORITY::STATE);
 	}
 
 	sendCommand("t0.txt=\"LOCKOUT\"");
@@ -211,13 +250,13 @@ void CNextion::setLockoutInt()
 
 void CNextion::setQuitInt()
 {
-	sendCommand("page MMDVM");
-	sendCommandAction(1U);
+	sendCommand("page MMDVM", NEXTION_PRIORITY::STATE);
+	sendCommandAction(1U, NEXTION_PRIORITY::STATE);
 
 	char command[100];
 	if (m_brightness>0) {
 		::sprintf(command, "dim=%u", m_idleBrightness);
-		sendCommand(command);
+		sendCommand(command, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(command, "t3.txt=\"%s\"", m_ipAddress.c_str());
@@ -235,14 +274,14 @@ void CNextion::setQuitInt()
 void CNextion::writeDStarInt(const std::string& my1, const std::string& my2, const std::string& your, const std::string& type, const std::string& reflector)
 {
 	if (m_mode != MODE_DSTAR) {
-		sendCommand("page DStar");
-		sendCommandAction(2U);
+		sendCommand("page DStar", NEXTION_PRIORITY::STATE);
+		sendCommandAction(2U, NEXTION_PRIORITY::STATE);
 	}
 
 	char text[50U];
 	if (m_brightness>0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(text, "t0.txt=\"%s %.8s/%4.4s\"", type.c_str(), my1.c_str(), my2.c_str());
@@ -268,16 +307,16 @@ void CNextion::writeDStarRSSIInt(int rssi)
 {
 	char text[25U];
 	::sprintf(text, "t3.txt=\"%ddBm\"", rssi);
-	sendCommand(text);
-	sendCommandAction(47U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(47U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::writeDStarBERInt(float ber)
 {
 	char text[25U];
 	::sprintf(text, "t4.txt=\"%.1f%%\"", ber);
-	sendCommand(text);
-	sendCommandAction(48U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(48U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::writeDStarTextInt(const std::string& text)
@@ -303,8 +342,8 @@ void CNextion::clearDStarInt()
 void CNextion::writeDMRInt(unsigned int slotNo, const std::string& src, bool group, unsigned int dst, const std::string& type)
 {
 	if (m_mode != MODE_DMR) {
-		sendCommand("page DMR");
-		sendCommandAction(3U);
+		sendCommand("page DMR", NEXTION_PRIORITY::STATE);
+		sendCommandAction(3U, NEXTION_PRIORITY::STATE);
 
 
 		if (slotNo == 1U) {
@@ -333,7 +372,7 @@ void CNextion::writeDMRInt(unsigned int slotNo, const std::string& src, bool gro
 	char text[50U];
 	if (m_brightness>0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	if (slotNo == 1U) {
@@ -380,13 +419,13 @@ void CNextion::writeDMRRSSIInt(unsigned int slotNo, int rssi)
 	if (slotNo == 1U) {
 		char text[25U];
 		::sprintf(text, "t4.txt=\"%ddBm\"", rssi);
-		sendCommand(text);
-		sendCommandAction(66U);
+		sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+		sendCommandAction(66U, NEXTION_PRIORITY::TELEMETRY);
 	} else {
 		char text[25U];
 		::sprintf(text, "t5.txt=\"%ddBm\"", rssi);
-		sendCommand(text);
-		sendCommandAction(74U);
+		sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+		sendCommandAction(74U, NEXTION_PRIORITY::TELEMETRY);
 	}
 }
 
@@ -439,13 +478,13 @@ void CNextion::writeDMRBERInt(unsigned int slotNo, float ber)
 	if (slotNo == 1U) {
 		char text[25U];
 		::sprintf(text, "t6.txt=\"%.1f%%\"", ber);
-		sendCommand(text);
-		sendCommandAction(67U);
+		sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+		sendCommandAction(67U, NEXTION_PRIORITY::TELEMETRY);
 	} else {
 		char text[25U];
 		::sprintf(text, "t7.txt=\"%.1f%%\"", ber);
-		sendCommand(text);
-		sendCommandAction(75U);
+		sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+		sendCommandAction(75U, NEXTION_PRIORITY::TELEMETRY);
 	}
 }
 
@@ -487,14 +526,14 @@ void CNextion::clearDMRInt(unsigned int slotNo)
 void CNextion::writeFusionInt(const std::string& source, const std::string& dest, unsigned char dgid, const std::string& type, const std::string& origin)
 {
 	if (m_mode != MODE_YSF) {
-		sendCommand("page YSF");
-		sendCommandAction(4U);
+		sendCommand("page YSF", NEXTION_PRIORITY::STATE);
+		sendCommandAction(4U, NEXTION_PRIORITY::STATE);
 	}
 
 	char text[30U];
 	if (m_brightness>0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(text, "t0.txt=\"%s %.10s\"", type.c_str(), source.c_str());
@@ -520,15 +559,15 @@ void CNextion::writeFusionRSSIInt(int rssi)
 {
 	char text[25U];
 	::sprintf(text, "t3.txt=\"%ddBm\"", rssi);
-	sendCommand(text);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::writeFusionBERInt(float ber)
 {
 	char text[25U];
 	::sprintf(text, "t4.txt=\"%.1f%%\"", ber);
-	sendCommand(text);
-	sendCommandAction(86U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(86U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::clearFusionInt()
@@ -544,14 +583,14 @@ void CNextion::clearFusionInt()
 void CNextion::writeP25Int(const std::string& source, bool group, unsigned int dest, const std::string& type)
 {
 	if (m_mode != MODE_P25) {
-		sendCommand("page P25");
-		sendCommandAction(5U);
+		sendCommand("page P25", NEXTION_PRIORITY::STATE);
+		sendCommandAction(5U, NEXTION_PRIORITY::STATE);
 	}
 
 	char text[30U];
 	if (m_brightness>0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(text, "t0.txt=\"%s %.10s\"", type.c_str(), source.c_str());
@@ -571,16 +610,16 @@ void CNextion::writeP25RSSIInt(int rssi)
 {
 	char text[25U];
 	::sprintf(text, "t2.txt=\"%ddBm\"", rssi);
-	sendCommand(text);
-	sendCommandAction(104U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(104U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::writeP25BERInt(float ber)
 {
 	char text[25U];
 	::sprintf(text, "t3.txt=\"%.1f%%\"", ber);
-	sendCommand(text);
-	sendCommandAction(105U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(105U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::clearP25Int()
@@ -595,14 +634,14 @@ void CNextion::clearP25Int()
 void CNextion::writeNXDNInt(const std::string& source, bool group, unsigned int dest, const std::string& type)
 {
 	if (m_mode != MODE_NXDN) {
-		sendCommand("page NXDN");
-		sendCommandAction(6U);
+		sendCommand("page NXDN", NEXTION_PRIORITY::STATE);
+		sendCommandAction(6U, NEXTION_PRIORITY::STATE);
 	}
 
 	char text[30U];
 	if (m_brightness>0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(text, "t0.txt=\"%s %.10s\"", type.c_str(), source.c_str());
@@ -622,16 +661,16 @@ void CNextion::writeNXDNRSSIInt(int rssi)
 {
 	char text[25U];
 	::sprintf(text, "t2.txt=\"%ddBm\"", rssi);
-	sendCommand(text);
-	sendCommandAction(124U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(124U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::writeNXDNBERInt(float ber)
 {
 	char text[25U];
 	::sprintf(text, "t3.txt=\"%.1f%%\"", ber);
-	sendCommand(text);
-	sendCommandAction(125U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(125U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::clearNXDNInt()
@@ -646,14 +685,14 @@ void CNextion::clearNXDNInt()
 void CNextion::writeFMInt(const std::string& status)
 {
 	if (m_mode != MODE_FM) {
-		sendCommand("page FM");
-		sendCommandAction(9U);
+		sendCommand("page FM", NEXTION_PRIORITY::STATE);
+		sendCommandAction(9U, NEXTION_PRIORITY::STATE);
 	}
 
 	char text[100U];
 	if (m_brightness > 0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(text, "t0.txt=\"%s\"", status.c_str());
@@ -669,8 +708,8 @@ void CNextion::writeFMRSSIInt(int rssi)
 {
 	char text[25U];
 	::sprintf(text, "t2.txt=\"%ddBm\"", rssi);
-	sendCommand(text);
-	sendCommandAction(148U);
+	sendCommand(text, NEXTION_PRIORITY::TELEMETRY);
+	sendCommandAction(148U, NEXTION_PRIORITY::TELEMETRY);
 }
 
 void CNextion::clearFMInt()
@@ -683,14 +722,14 @@ void CNextion::clearFMInt()
 void CNextion::writePOCSAGInt(uint32_t ric, const std::string& message)
 {
 	if (m_mode != MODE_POCSAG) {
-		sendCommand("page POCSAG");
-		sendCommandAction(7U);
+		sendCommand("page POCSAG", NEXTION_PRIORITY::STATE);
+		sendCommandAction(7U, NEXTION_PRIORITY::STATE);
 	}
 
 	char text[200U];
 	if (m_brightness>0) {
 		::sprintf(text, "dim=%u", m_brightness);
-		sendCommand(text);
+		sendCommand(text, NEXTION_PRIORITY::STATE);
 	}
 
 	::sprintf(text, "t0.txt=\"RIC: %u\"", ric);
@@ -728,115 +767,347 @@ void CNextion::clearCWInt()
 	sendCommandAction(11U);
 }
 
-void CNextion::clockInt(unsigned int ms)
+void CNextion::updateClock()
 {
-	assert(m_serial != nullptr);
-
 	// Update the clock display in IDLE mode every 400ms
-	m_clockDisplayTimer.clock(ms);
-	if (m_displayClock && (m_mode == MODE_IDLE || m_mode == MODE_CW) && m_clockDisplayTimer.isRunning() && m_clockDisplayTimer.hasExpired()) {
-		// Skip clock update if the output buffer is more than half full.
-		// Over MQTT the drain rate is much slower than direct serial, so
-		// piling on timer commands can cause buffer overflow.
-		if (m_output.freeSpace() > 100U) {
-			time_t currentTime;
-			struct tm *Time;
-			::time(&currentTime);                   // Get the current time
-
-			if (m_utc)
-				Time = ::gmtime(&currentTime);
-			else
-				Time = ::localtime(&currentTime);
-
-			::setlocale(LC_TIME,"");
-			char text[50U];
-			::strftime(text, 50, "t2.txt=\"%x %X\"", Time);
-			sendCommand(text);
-		}
+	if (m_displayClock && (m_mode == MODE_IDLE || m_mode == MODE_CW)) {
+		// The clock is sent last of all and a waiting update is replaced,
+		// so it can no longer hold up anything else on a slow link
+		time_t currentTime;
+		struct tm *Time;
+		::time(&currentTime);                   // Get the current time
+
+		if (m_utc)
+			Time = ::gmtime(&currentTime);
+		else
+			Time = ::localtime(&currentTime);
+
+		::setlocale(LC_TIME,"");
+		char text[50U];
+		::strftime(text, 50, "t2.txt=\"%x %X\"", Time);
+		sendCommand(text, NEXTION_PRIORITY::CLOCK);
 
 		m_clockDisplayTimer.start(); // restart the clock display timer
 	}
+}
 
+void CNextion::responseTimeout()
+{
 	// Timeout stale waits — over MQTT, responses can be lost or delayed.
-	// Without this, m_waiting stays true forever and the queue never drains.
-	m_waitingTimer.clock(ms);
-	if (m_waiting && m_waitingTimer.isRunning() && m_waitingTimer.hasExpired()) {
+	// Without this, the window stays full forever and the queue never drains.
+	if (m_sendPtr != m_ackPtr) {
 		LogDebug("Nextion response timeout, resuming queue");
-		m_waiting = false;
+		m_ackPtr   = m_sendPtr;
+		m_recovery = m_window;
 		m_waitingTimer.stop();
+		invalidate();
 	}
+}
 
-	unsigned char c;
-	unsigned int len;
-	while ((len = m_serial->read(&c, 1U)) == 1U) {
-		::memmove(m_reply + 1U, m_reply + 0U, MAX_REPLY_LENGTH - 1U);
-		m_reply[0U] = c;
-
-		// Do we have a valid reply?
-		if (m_reply[0U] == 0xFFU && m_reply[1U] == 0xFFU && m_reply[2U] == 0xFFU) {
-			switch (m_reply[3U]) {
-				case 0x00U:	// Invalid instruction
-				case 0x02U:	// Invalid component ID
-				case 0x03U:	// Invalid page ID
-				case 0x04U:	// Invalid picture ID
-				case 0x05U:	// Invalid font ID
-				case 0x06U:	// Invalid file operation
-				case 0x09U:	// Invalid CRC
-				case 0x11U:	// Invalid baud rate setting
-				case 0x12U:	// Invalid waveform ID or channel number
-				case 0x1AU:	// Invalid variable name or operation
-				case 0x1BU:	// Invalid variable operation
-				case 0x1CU:	// Assignment failed to assign
-				case 0x1DU:	// EEPROM operation failed
-				case 0x1EU:	// Invalid quantity of parameters
-				case 0x1FU:	// IO operation failed
-				case 0x20U:	// Escape character invalid
-				case 0x23U:	// Variable name too long
-				case 0x24U:	// Serial buffer overflow
-					LogWarning("Nextion error response - 0x%02X", m_reply[3U]);
-					break;
-				case 0x01U:	// Instruction successful
-					break;
-				default:	// Unhandled response
-					LogWarning("Unknown Nextion response - 0x%02X", m_reply[3U]);
-					break;
-			}
+void CNextion::clockInt()
+{
+	assert(m_serial != nullptr);
 
-			m_waiting = false;
-			m_waitingTimer.stop();
-			break;
+	unsigned char data[READ_LENGTH];
+	int len;
+	while ((len = m_serial->readAvailable(data, READ_LENGTH)) > 0) {
+		for (int i = 0; i < len; i++) {
+			if (m_decoder.decode(data[i]))
+				processFrame();
 		}
+
+		if (len < int(READ_LENGTH))
+			break;
 	}
 
-	if (!m_waiting) {
-		if (!m_output.isEmpty()) {
-			m_mutex.lock();
+	// Keep up to the window of commands outstanding, or only one while
+	// recovering from an error
+	unsigned int window = (m_recovery > 0U) ? 1U : m_window;
 
-			unsigned char len = 0U;
-			m_output.getData(&len, 1U);
+	while ((m_sendPtr - m_ackPtr) < window && !m_output.isEmpty()) {
+		unsigned int len = 0U;
+		const unsigned char* data = m_output.peek(len);
 
-			unsigned char buffer[200U];
-			m_output.getData(buffer, len);
+		CUtils::dump(1U, "Nextion output", data, len);
 
-			m_mutex.unlock();
+		m_serial->write(data, len);
+		m_sent[m_sendPtr++ & (MAX_WINDOW - 1U)] = ::MetricsNow();
 
-			CUtils::dump(1U, "Nextion output", buffer, len);
+		m_output.remove();
 
-			m_serial->write(buffer, len);
+		::MetricsLevel(METRIC_LEVEL::NEXTION_OUTPUT, m_outputLevel, m_output.size());
 
-			m_waiting = true;
+		if (!m_waitingTimer.isRunning())
 			m_waitingTimer.start();
+	}
+
+	// Everything sent this pass goes out together
+	m_serial->flush();
+}
+
+void CNextion::processFrame()
+{
+	const unsigned char* data = m_decoder.getData();
+	unsigned int length       = m_decoder.getLength();
+	unsigned char code        = m_decoder.getCode();
+
+	switch (code) {
+		case 0x65U:	// Touch event
+			LogDebug("Nextion touch event, page %u component %u %s", data[0U], data[1U], data[2U] == 0x01U ? "press" : "release");
+			break;
+		case 0x66U:	// Current page
+			LogDebug("Nextion current page %u", data[0U]);
+			break;
+		case 0x67U:	// Touch coordinates
+		case 0x68U:	// Touch coordinates in sleep
+			LogDebug("Nextion touch at %u,%u", (data[0U] << 8) | data[1U], (data[2U] << 8) | data[3U]);
+			break;
+		case 0x70U:	// String data
+			LogDebug("Nextion string data \"%.*s\"", int(length), data);
+			break;
+		case 0x71U:	// Numeric data
+			LogDebug("Nextion numeric data %d", int(data[0U] | (data[1U] << 8) | (data[2U] << 16) | ((unsigned int)data[3U] << 24)));
+			break;
+		case 0x86U:	// Auto sleep
+			LogDebug("Nextion has gone to sleep");
+			break;
+		case 0x87U:	// Auto wake
+			LogDebug("Nextion has woken up");
+			break;
+		case 0x00U:	// Startup, or an invalid instruction
+		case 0x88U:	// Ready
+			if (code == 0x88U || length == 2U) {
+				restart();
+				break;
+			}
+			processReply(code);
+			break;
+		default:
+			processReply(code);
+			break;
+	}
+}
+
+// Probes the display with sendme and raises the baud rate as far as it answers
+void CNextion::negotiate()
+{
+	// Only a local UART can change its speed
+	unsigned int current = m_serial->getSpeed();
+	if (m_baudrate == 0U || current == 0U)
+		return;
+
+	// The display keeps a raised rate until it is powered off, so it may
+	// still be at the rate left by an earlier run
+	if (!ping()) {
+		current = probe();
+		if (current == 0U) {
+			LogWarning("Cannot find the Nextion display, staying at %u baud", m_serial->getSpeed());
+			return;
 		}
 	}
+
+	for (unsigned int i = 0U; i < RAISED_SPEEDS_COUNT; i++) {
+		unsigned int speed = RAISED_SPEEDS[i];
+		if (speed > m_baudrate)
+			continue;
+
+		if (speed == current) {
+			LogMessage("Nextion display is at %u baud", speed);
+			return;
+		}
+
+		char command[30U];
+		::sprintf(command, "baud=%u\xFF\xFF\xFF", speed);
+		m_serial->write((unsigned char*)command, (unsigned int)::strlen(command));
+		m_serial->drain();
+
+		// The reply, if any, is sent at the old rate
+		CThread::sleep(SETTLE_TIME);
+
+		if (m_serial->setSpeed(speed) && ping()) {
+			LogMessage("Nextion display raised to %u baud", speed);
+			return;
+		}
+
+		LogWarning("Nextion display does not answer at %u baud", speed);
+
+		// The display may hear but not be heard, so ask it to go back
+		::sprintf(command, "baud=%u\xFF\xFF\xFF", current);
+		m_serial->write((unsigned char*)command, (unsigned int)::strlen(command));
+		m_serial->drain();
+		CThread::sleep(SETTLE_TIME);
+
+		// The display may or may not have changed over
+		if (!m_serial->setSpeed(current) || !ping()) {
+			current = probe();
+			if (current == 0U) {
+				LogWarning("Cannot find the Nextion display, staying at %u baud", m_serial->getSpeed());
+				return;
+			}
+
+			if (current == speed) {
+				LogMessage("Nextion display raised to %u baud", speed);
+				return;
+			}
+		}
+	}
+
+	LogMessage("Nextion display stays at %u baud", current);
+}
+
+unsigned int CNextion::probe()
+{
+	unsigned int original = m_serial->getSpeed();
+
+	for (unsigned int i = 0U; i < PROBE_SPEEDS_COUNT; i++) {
+		if (PROBE_SPEEDS[i] == original)
+			continue;
+
+		if (m_serial->setSpeed(PROBE_SPEEDS[i]) && ping())
+			return PROBE_SPEEDS[i];
+	}
+
+	m_serial->setSpeed(original);
+
+	return 0U;
+}
+
+bool CNextion::ping()
+{
+	unsigned char data[READ_LENGTH];
+
+	// Anything waiting was sent before the rate changed
+	while (m_serial->readAvailable(data, READ_LENGTH) > 0)
+		;
+	m_decoder.reset();
+
+	// The leading terminator ends any partial command in the display, and
+	// sendme is answered whatever bkcmd is set to
+	const char* command = "\xFF\xFF\xFFsendme\xFF\xFF\xFF";
+	m_serial->write((const unsigned char*)command, (unsigned int)::strlen(command));
+	m_serial->drain();
+
+	for (unsigned int ms = 0U; ms < PROBE_TIME; ms += 10U) {
+		CThread::sleep(10U);
+
+		int len;
+		while ((len = m_serial->readAvailable(data, READ_LENGTH)) > 0) {
+			for (int i = 0; i < len; i++) {
+				if (m_decoder.decode(data[i]) && m_decoder.getCode() == 0x66U) {
+					m_decoder.reset();
+					return true;
+				}
+			}
+		}
+
+		if (len < 0)
+			break;
+	}
+
+	m_decoder.reset();
+
+	return false;
+}
+
+// The display has been reset, so anything in flight has been lost and
+// bkcmd is back to its default
+void CNextion::restart()
+{
+	LogMessage("Nextion display has restarted");
+
+	m_ackPtr   = m_sendPtr;
+	m_recovery = m_window;
+	m_waitingTimer.stop();
+	invalidate();
+
+	queueCommand("bkcmd=3", NEXTION_PRIORITY::STATE, true);
+}
+
+void CNextion::processReply(unsigned char code)
+{
+	switch (code) {
+		case 0x00U:	// Invalid instruction
+		case 0x02U:	// Invalid component ID
+		case 0x03U:	// Invalid page ID
+		case 0x04U:	// Invalid picture ID
+		case 0x05U:	// Invalid font ID
+		case 0x06U:	// Invalid file operation
+		case 0x09U:	// Invalid CRC
+		case 0x11U:	// Invalid baud rate setting
+		case 0x12U:	// Invalid waveform ID or channel number
+		case 0x1AU:	// Invalid variable name or operation
+		case 0x1BU:	// Invalid variable operation
+		case 0x1CU:	// Assignment failed to assign
+		case 0x1DU:	// EEPROM operation failed
+		case 0x1EU:	// Invalid quantity of parameters
+		case 0x1FU:	// IO operation failed
+		case 0x20U:	// Escape character invalid
+		case 0x23U:	// Variable name too long
+		case 0x24U:	// Serial buffer overflow
+			LogWarning("Nextion error response - 0x%02X", code);
+			m_recovery = m_window;
+			invalidate();
+			break;
+		case 0x01U:	// Instruction successful
+			if (m_recovery > 0U)
+				m_recovery--;
+			break;
+		default:	// Unhandled response
+			LogWarning("Unknown Nextion response - 0x%02X", code);
+			m_recovery = m_window;
+			invalidate();
+			break;
+	}
+
+	// Replies come back in the order that the commands were sent
+	if (m_sendPtr != m_ackPtr) {
+		// Timed from when the reply arrived, not from when it was decoded
+		unsigned long long sent = m_sent[m_ackPtr++ & (MAX_WINDOW - 1U)];
+		unsigned long long received = m_serial->getReadTime();
+		if (received >= sent)
+			::MetricsTime(METRIC_TIME::NEXTION_ACK, received - sent);
+
+		if (m_sendPtr != m_ackPtr)
+			m_waitingTimer.start();
+		else
+			m_waitingTimer.stop();
+	}
+}
+
+unsigned int CNextion::getTimeoutInt()
+{
+	// Replies wake us up through the serial port or MQTT descriptors, and
+	// the clock and response timers through the timer service
+	unsigned int window = (m_recovery > 0U) ? 1U : m_window;
+	if (!m_output.isEmpty() && (m_sendPtr - m_ackPtr) < window)
+		return 0U;
+
+	return CDisplay::getTimeoutInt();
+}
+
+int CNextion::getFD() const
+{
+	assert(m_serial != nullptr);
+
+	return m_serial->getFD();
+}
+
+bool CNextion::wantWrite() const
+{
+	assert(m_serial != nullptr);
+
+	return m_serial->wantWrite();
 }
 
 void CNextion::close()
 {
+	::MetricsLevel(METRIC_LEVEL::NEXTION_OUTPUT, m_outputLevel, 0U);
+
 	m_serial->close();
 	delete m_serial;
 }
 
-void CNextion::sendCommandAction(unsigned int status)
+void CNextion::sendCommandAction(unsigned int status, NEXTION_PRIORITY priority)
 {
 	if (!(m_screenLayout & LAYOUT_DIY))
 		return;
@@ -844,20 +1115,63 @@ void CNextion::sendCommandAction(unsigned int status)
 	char text[30U];
 	::sprintf(text, "MMDVM.status.val=%u", status);
 
-	sendCommand(text);
-	sendCommand("click S0,1");
+	// The click acts on the status, so it is always sent as it is
+	queueCommand(text, priority, false);
+	queueCommand("click S0,1", priority, false);
+}
+
+// Any of the outstanding commands may have failed, or the display may have
+// restarted, so nothing is known about what it shows
+void CNextion::invalidate()
+{
+	m_shadow.clear();
 }
 
-void CNextion::sendCommand(const std::string& command)
+void CNextion::sendCommand(const std::string& command, NEXTION_PRIORITY priority)
 {
-	unsigned char len = (unsigned char)command.size();
-	unsigned char c = len + 3U;
+	if (command.compare(0U, 5U, "page ") == 0) {
+		// Loading a page resets its components, so the shadow starts again.
+		// It is always sent, even for the current page, as the error and
+		// lockout screens rely on the reload to blank the idle screen.
+		m_shadow.clear();
+	} else {
+		// Drop assignments that would not change what is on the display
+		unsigned int pos = CNextionQueue::getKeyLength(command);
+		if (pos > 0U) {
+			std::string key   = command.substr(0U, pos);
+			std::string value = command.substr(pos + 1U);
+
+			std::unordered_map<std::string, std::string>::iterator it = m_shadow.find(key);
+			if (it != m_shadow.end()) {
+				if (it->second == value) {
+					::MetricsCount(METRIC_COUNT::NEXTION_SUPPRESSED);
+					return;
+				}
 
-	m_mutex.lock();
+				it->second = value;
+			} else {
+				m_shadow[key] = value;
+			}
+		}
+	}
 
-	m_output.addData(&c, 1U);
-	m_output.addData((unsigned char*)command.c_str(), len);
-	m_output.addData((unsigned char*)"\xFF\xFF\xFF", 3U);
+	queueCommand(command, priority, true);
+}
+
+void CNextion::queueCommand(const std::string& command, NEXTION_PRIORITY priority, bool merge)
+{
+	m_output.add(command, priority, merge);
+
+	// A dropped value never reaches the display, so the shadow must not
+	// claim that it is showing it
+	std::string dropped;
+	while (m_output.getDropped(dropped)) {
+		unsigned int pos = CNextionQueue::getKeyLength(dropped);
+		if (pos > 0U)
+			m_shadow.erase(dropped.substr(0U, pos));
+		else if (dropped.compare(0U, 5U, "page ") == 0)
+			invalidate();
+	}
 
-	m_mutex.unlock();
+	::MetricsLevel(METRIC_LEVEL::NEXTION_OUTPUT, m_outputLevel, m_output.size());
 }
@@ -21,23 +21,29 @@
 
 #include "Display.h"
 #include "Defines.h"
-#include "RingBuffer.h"
+#include "NextionDecoder.h"
+#include "NextionQueue.h"
 #include "SerialPort.h"
-#include "Mutex.h"
 #include "Timer.h"
 #include "Thread.h"
+
+#include <unordered_map>
 #include <string>
 
 class CNextion : public CDisplay
 {
 public:
-	CNextion(const std::string& callsign, unsigned int id, bool duplex, ISerialPort* serial, unsigned int brightness, bool displayClock, bool utc, unsigned int idleBrightness, unsigned int screenLayout, bool displayTempInF);
+	CNextion(const std::string& callsign, unsigned int id, bool duplex, ISerialPort* serial, unsigned int brightness, bool displayClock, bool utc, unsigned int idleBrightness, unsigned int screenLayout, bool displayTempInF, unsigned int window, unsigned int baudrate);
 	virtual ~CNextion();
 
 	virtual bool open();
 
 	virtual void close();
 
+	virtual int getFD() const;
+
+	virtual bool wantWrite() const;
+
 protected:
 	virtual void setIdleInt();
 	virtual void setErrorInt();
@@ -81,7 +87,8 @@ protected:
 	virtual void writeCWInt();
 	virtual void clearCWInt();
 
-	virtual void clockInt(unsigned int ms);
+	virtual void clockInt();
+	virtual unsigned int getTimeoutInt();
 
 private:
 	std::string    m_callsign;
@@ -97,14 +104,33 @@ private:
 	unsigned int   m_screenLayout;
 	CTimer         m_clockDisplayTimer;
 	bool           m_displayTempInF;
-	CRingBuffer<unsigned char> m_output;
-	CMutex         m_mutex;
-	unsigned char* m_reply;
-	bool           m_waiting;
+	CNextionQueue  m_output;
+	CNextionDecoder m_decoder;
+	unsigned int   m_window;
+	unsigned int   m_baudrate;
+	unsigned int   m_sendPtr;
+	unsigned int   m_ackPtr;
+	unsigned int   m_recovery;
 	CTimer         m_waitingTimer;
+	unsigned long long* m_sent;
+	unsigned int   m_outputLevel;
+	std::unordered_map<std::string, std::string> m_shadow;
+
+	void negotiate();
+	unsigned int probe();
+	bool ping();
+
+	void updateClock();
+	void responseTimeout();
+
+	void processFrame();
+	void processReply(unsigned char code);
+	void restart();
+	void invalidate();
 
-	void sendCommand(const std::string& command);
-	void sendCommandAction(unsigned int status);
+	void sendCommand(const std::string& command, NEXTION_PRIORITY priority = NEXTION_PRIORITY::CALL);
+	void sendCommandAction(unsigned int status, NEXTION_PRIORITY priority = NEXTION_PRIORITY::CALL);
+	void queueCommand(const std::string& command, NEXTION_PRIORITY priority, bool merge);
 };
 
 #endif
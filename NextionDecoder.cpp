@@ -0,0 +1,156 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "NextionDecoder.h"
+#include "Log.h"
+
+#include <cassert>
+
+CNextionDecoder::CNextionDecoder() :
+m_state(STATE::CODE),
+m_code(0x00U),
+m_length(0U),
+m_wanted(0U),
+m_count(0U),
+m_overflow(false)
+{
+}
+
+CNextionDecoder::~CNextionDecoder()
+{
+}
+
+bool CNextionDecoder::decode(unsigned char c)
+{
+	switch (m_state) {
+		case STATE::CODE:
+			// Stray terminator bytes are not the start of a frame
+			if (c != 0xFFU)
+				start(c);
+			return false;
+
+		case STATE::DATA:
+			m_data[m_length++] = c;
+			if (m_length == m_wanted) {
+				m_state = STATE::TERMINATOR;
+				m_count = 0U;
+			}
+			return false;
+
+		case STATE::STRING:
+			// The first two bytes of the terminator are stored as data
+			// until the third one arrives
+			if (c == 0xFFU) {
+				m_count++;
+				if (m_count == 3U) {
+					m_state = STATE::CODE;
+					if (m_overflow) {
+						LogWarning("Nextion return frame 0x%02X is too long, dropping it", m_code);
+						return false;
+					}
+
+					m_length -= 2U;
+					return true;
+				}
+			} else {
+				m_count = 0U;
+			}
+
+			if (m_length < (NEXTION_FRAME_LENGTH + 2U))
+				m_data[m_length++] = c;
+			else
+				m_overflow = true;
+			return false;
+
+		case STATE::TERMINATOR:
+			if (c == 0xFFU) {
+				m_count++;
+				if (m_count == 3U) {
+					m_state = STATE::CODE;
+					return true;
+				}
+
+				return false;
+			}
+
+			LogDebug("Nextion return frame 0x%02X is not terminated, dropping it", m_code);
+			start(c);
+			return false;
+
+		default:
+			reset();
+			return false;
+	}
+}
+
+unsigned char CNextionDecoder::getCode() const
+{
+	return m_code;
+}
+
+const unsigned char* CNextionDecoder::getData() const
+{
+	return m_data;
+}
+
+unsigned int CNextionDecoder::getLength() const
+{
+	return m_length;
+}
+
+void CNextionDecoder::reset()
+{
+	m_state = STATE::CODE;
+	m_length = 0U;
+	m_count  = 0U;
+}
+
+void CNextionDecoder::start(unsigned char code)
+{
+	m_code     = code;
+	m_length   = 0U;
+	m_count    = 0U;
+	m_overflow = false;
+
+	switch (code) {
+		case 0x65U:	// Touch event
+			m_wanted = 3U;
+			m_state  = STATE::DATA;
+			break;
+		case 0x66U:	// Current page
+			m_wanted = 1U;
+			m_state  = STATE::DATA;
+			break;
+		case 0x67U:	// Touch coordinates
+		case 0x68U:	// Touch coordinates in sleep
+			m_wanted = 5U;
+			m_state  = STATE::DATA;
+			break;
+		case 0x71U:	// Numeric data
+			m_wanted = 4U;
+			m_state  = STATE::DATA;
+			break;
+		case 0x00U:	// Invalid instruction, or the startup frame 00 00 00
+		case 0x70U:	// String data
+			m_state = STATE::STRING;
+			break;
+		default:	// Status codes and events without data
+			m_state = STATE::TERMINATOR;
+			break;
+	}
+}
@@ -0,0 +1,63 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(NEXTIONDECODER_H)
+#define	NEXTIONDECODER_H
+
+// The longest string return that is kept, longer ones are dropped
+const unsigned int NEXTION_FRAME_LENGTH = 200U;
+
+// Splits the bytes from a Nextion display into its return frames, a code
+// followed by any data and then FF FF FF. The data length is fixed by the
+// code, except for strings and the startup frame which run to the
+// terminator. Each byte costs a constant amount of work, and a frame that
+// is not terminated where expected is dropped and decoding starts again.
+class CNextionDecoder {
+public:
+	CNextionDecoder();
+	~CNextionDecoder();
+
+	// Returns true when the byte completes a frame
+	bool decode(unsigned char c);
+
+	unsigned char        getCode() const;
+	const unsigned char* getData() const;
+	unsigned int         getLength() const;
+
+	void reset();
+
+private:
+	enum class STATE {
+		CODE,
+		DATA,
+		STRING,
+		TERMINATOR
+	};
+
+	STATE         m_state;
+	unsigned char m_code;
+	unsigned char m_data[NEXTION_FRAME_LENGTH + 2U];
+	unsigned int  m_length;
+	unsigned int  m_wanted;
+	unsigned int  m_count;
+	bool          m_overflow;
+
+	void start(unsigned char code);
+};
+
+#endif
@@ -0,0 +1,265 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "NextionQueue.h"
+#include "Metrics.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+CNextionQueue::CNextionQueue(unsigned int length) :
+m_length(length),
+m_count(0U),
+m_dropped()
+{
+	assert(length > 0U);
+
+	for (unsigned int i = 0U; i < NEXTION_PRIORITIES; i++) {
+		m_classes[i].m_entries = new CEntry[length];
+		m_classes[i].m_head    = 0U;
+		m_classes[i].m_used    = 0U;
+	}
+}
+
+CNextionQueue::~CNextionQueue()
+{
+	for (unsigned int i = 0U; i < NEXTION_PRIORITIES; i++)
+		delete[] m_classes[i].m_entries;
+}
+
+bool CNextionQueue::add(const std::string& command, NEXTION_PRIORITY priority, bool merge)
+{
+	unsigned int p = (unsigned int)priority;
+	assert(p < NEXTION_PRIORITIES);
+
+	CClass& cls = m_classes[p];
+
+	unsigned int keyLength = merge ? getKeyLength(command) : 0U;
+
+	if (command.compare(0U, 5U, "page ") == 0) {
+		// The new page resets its components, so nothing lower is wanted
+		for (unsigned int i = p + 1U; i < NEXTION_PRIORITIES; i++) {
+			CClass& lower = m_classes[i];
+			for (unsigned int j = 0U; j < lower.m_used; j++) {
+				CEntry& entry = lower.m_entries[(lower.m_head + j) % m_length];
+				if (entry.m_live)
+					drop(entry);
+			}
+
+			trim(lower);
+		}
+	} else if (keyLength > 0U) {
+		// Older values waiting in the lower classes would overwrite this one
+		for (unsigned int i = p + 1U; i < NEXTION_PRIORITIES; i++) {
+			CEntry* entry;
+			while ((entry = find(m_classes[i], command, keyLength, false)) != nullptr)
+				drop(*entry);
+
+			trim(m_classes[i]);
+		}
+
+		CEntry* entry = find(cls, command, keyLength, true);
+		if (entry != nullptr) {
+			set(*entry, command, keyLength);
+			::MetricsCount(METRIC_COUNT::NEXTION_COALESCED);
+			return true;
+		}
+	}
+
+	bool ret = true;
+
+	if (m_count == m_length || cls.m_used == m_length) {
+		if (cls.m_used == m_length || !shed(p)) {
+			LogError("Nextion queue overflow, dropping \"%s\"", command.c_str());
+			m_dropped.push_back(command);
+			return false;
+		}
+
+		ret = false;
+	}
+
+	set(cls.m_entries[(cls.m_head + cls.m_used) % m_length], command, keyLength);
+	cls.m_used++;
+	m_count++;
+
+	return ret;
+}
+
+bool CNextionQueue::getDropped(std::string& command)
+{
+	if (m_dropped.empty())
+		return false;
+
+	command = m_dropped.back();
+	m_dropped.pop_back();
+
+	return true;
+}
+
+const unsigned char* CNextionQueue::peek(unsigned int& length) const
+{
+	for (unsigned int i = 0U; i < NEXTION_PRIORITIES; i++) {
+		const CClass& cls = m_classes[i];
+
+		// The head entry of a class is always live
+		if (cls.m_used > 0U) {
+			const CEntry& entry = cls.m_entries[cls.m_head];
+
+			length = entry.m_length;
+
+			return entry.m_text;
+		}
+	}
+
+	length = 0U;
+
+	return nullptr;
+}
+
+void CNextionQueue::remove()
+{
+	for (unsigned int i = 0U; i < NEXTION_PRIORITIES; i++) {
+		CClass& cls = m_classes[i];
+
+		if (cls.m_used > 0U) {
+			drop(cls.m_entries[cls.m_head]);
+			trim(cls);
+			return;
+		}
+	}
+}
+
+void CNextionQueue::clear()
+{
+	for (unsigned int i = 0U; i < NEXTION_PRIORITIES; i++) {
+		m_classes[i].m_head = 0U;
+		m_classes[i].m_used = 0U;
+	}
+
+	m_count = 0U;
+
+	m_dropped.clear();
+}
+
+unsigned int CNextionQueue::size() const
+{
+	return m_count;
+}
+
+unsigned int CNextionQueue::freeSpace() const
+{
+	return m_length - m_count;
+}
+
+bool CNextionQueue::isEmpty() const
+{
+	return m_count == 0U;
+}
+
+unsigned int CNextionQueue::getKeyLength(const std::string& command)
+{
+	std::string::size_type pos = command.find('=');
+	if (pos == std::string::npos || pos == 0U)
+		return 0U;
+
+	if (command.find(' ') < pos)
+		return 0U;
+
+	return (unsigned int)pos;
+}
+
+// Looks back from the newest entry for a value for the same attribute,
+// optionally stopping at the first barrier
+CNextionQueue::CEntry* CNextionQueue::find(CClass& cls, const std::string& command, unsigned int keyLength, bool barriers)
+{
+	for (unsigned int i = cls.m_used; i > 0U; i--) {
+		CEntry& entry = cls.m_entries[(cls.m_head + i - 1U) % m_length];
+		if (!entry.m_live)
+			continue;
+
+		if (entry.m_keyLength == 0U) {
+			if (barriers)
+				return nullptr;
+			continue;
+		}
+
+		if (entry.m_keyLength == keyLength && ::memcmp(entry.m_text, command.c_str(), keyLength) == 0)
+			return &entry;
+	}
+
+	return nullptr;
+}
+
+void CNextionQueue::set(CEntry& entry, const std::string& command, unsigned int keyLength)
+{
+	unsigned int length = (unsigned int)command.size();
+	if (length > NEXTION_COMMAND_LENGTH)
+		length = NEXTION_COMMAND_LENGTH;
+
+	::memcpy(entry.m_text, command.c_str(), length);
+	::memcpy(entry.m_text + length, "\xFF\xFF\xFF", 3U);
+
+	entry.m_length    = length + 3U;
+	entry.m_keyLength = keyLength;
+	entry.m_live      = true;
+}
+
+void CNextionQueue::drop(CEntry& entry)
+{
+	assert(entry.m_live);
+
+	entry.m_live = false;
+	m_count--;
+}
+
+// Dropped entries are left in place until they reach the head of their class
+void CNextionQueue::trim(CClass& cls)
+{
+	while (cls.m_used > 0U && !cls.m_entries[cls.m_head].m_live) {
+		cls.m_head = (cls.m_head + 1U) % m_length;
+		cls.m_used--;
+	}
+
+	if (cls.m_used == 0U)
+		cls.m_head = 0U;
+}
+
+// Makes room by dropping the oldest command of the lowest class below the given one
+bool CNextionQueue::shed(unsigned int priority)
+{
+	for (unsigned int i = NEXTION_PRIORITIES - 1U; i > priority; i--) {
+		CClass& cls = m_classes[i];
+
+		if (cls.m_used > 0U) {
+			CEntry& entry = cls.m_entries[cls.m_head];
+
+			LogWarning("Nextion queue full, shedding \"%.*s\"", int(entry.m_length - 3U), entry.m_text);
+			::MetricsCount(METRIC_COUNT::NEXTION_SHED);
+
+			m_dropped.push_back(std::string((const char*)entry.m_text, entry.m_length - 3U));
+
+			drop(entry);
+			trim(cls);
+
+			return true;
+		}
+	}
+
+	return false;
+}
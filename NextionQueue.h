@@ -0,0 +1,102 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(NEXTIONQUEUE_H)
+#define	NEXTIONQUEUE_H
+
+#include <string>
+#include <vector>
+
+// The longest command, plus its three byte terminator
+const unsigned int NEXTION_COMMAND_LENGTH = 255U;
+
+// The classes of command, highest priority first
+enum class NEXTION_PRIORITY {
+	STATE,
+	CALL,
+	TELEMETRY,
+	CLOCK
+};
+
+const unsigned int NEXTION_PRIORITIES = 4U;
+
+// The commands waiting to be sent to a Nextion display. A new value for a
+// component attribute, such as t2.txt, replaces a value for it that is
+// still waiting, keeping its place in the queue. Any command that is not an
+// assignment, such as page or click, is a barrier that later values are not
+// merged across.
+//
+// Each priority class is sent in order, and the higher classes go first. A
+// value also cancels any waiting value for the same attribute in the lower
+// classes, and a page command cancels everything waiting in the lower
+// classes. When the queue is full the oldest command of the lowest class
+// is shed to make room. It is only used from the thread that drives the
+// display.
+class CNextionQueue {
+public:
+	CNextionQueue(unsigned int length);
+	~CNextionQueue();
+
+	// Returns false if a command, this one or an older one, has been dropped.
+	// A command that is not to be merged is kept as a barrier.
+	bool add(const std::string& command, NEXTION_PRIORITY priority, bool merge = true);
+
+	// Returns the dropped commands one at a time, as they will never reach
+	// the display. Merged values are not returned, the newer value is sent.
+	bool getDropped(std::string& command);
+
+	// The next command with its terminator, ready to be written
+	const unsigned char* peek(unsigned int& length) const;
+	void remove();
+
+	void clear();
+
+	unsigned int size() const;
+	unsigned int freeSpace() const;
+	bool         isEmpty() const;
+
+	// The length of the attribute name if the command is an assignment
+	static unsigned int getKeyLength(const std::string& command);
+
+private:
+	struct CEntry {
+		unsigned char m_text[NEXTION_COMMAND_LENGTH + 3U];
+		unsigned int  m_length;
+		unsigned int  m_keyLength;
+		bool          m_live;
+	};
+
+	struct CClass {
+		CEntry*      m_entries;
+		unsigned int m_head;
+		unsigned int m_used;
+	};
+
+	unsigned int m_length;
+	CClass       m_classes[NEXTION_PRIORITIES];
+	unsigned int m_count;
+	std::vector<std::string> m_dropped;
+
+	CEntry* find(CClass& cls, const std::string& command, unsigned int keyLength, bool barriers);
+	void    set(CEntry& entry, const std::string& command, unsigned int keyLength);
+	void    drop(CEntry& entry);
+	void    trim(CClass& cls);
+	bool    shed(unsigned int priority);
+};
+
+#endif
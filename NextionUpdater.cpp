@@ -153,10 +153,15 @@ int CNextionUpdater::run()
 
 	const std::string displayName = m_conf.getMMDVMName() + "/display-out";
 
-	std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>> subscriptions;
-	subscriptions.push_back(std::make_pair(displayName, CNextionUpdater::onDisplay));
+	std::vector<std::pair<std::string, MQTTHandler>> subscriptions;
+	subscriptions.push_back(std::make_pair(displayName, MQTTHandler([this](const unsigned char* data, unsigned int length) { onDisplay(data, length); })));
+
+	m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive(), MQTT_QOS(m_conf.getMQTTQoS()));
+
+	std::vector<CMQTTTopic> topics = m_conf.getMQTTTopics();
+	for (const auto& it : topics)
+		m_mqtt->setPolicy(it.m_topic, MQTT_QOS(it.m_qos), it.m_retain, it.m_length, MQTT_OVERFLOW(it.m_overflow));
 
-	m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive());
 	ret = m_mqtt->open();
 	if (!ret) {
 		::fprintf(stderr, "NextionUpdater: unable to start the MQTT Publisher\n");
@@ -223,6 +228,7 @@ bool CNextionUpdater::uploadViaUART(const std::string& port, FILE* file, long fi
 	char command[100U];
 	::sprintf(command, "whmi-wri %ld,%u,0\xFF\xFF\xFF", fileSize, baudrate);
 	serial.write((unsigned char*)command, (unsigned int)::strlen(command));
+	serial.drain();
 
 	CUtils::dump(1U, "Nextion command", (unsigned char*)command, (unsigned int)::strlen(command));
 
@@ -255,6 +261,8 @@ bool CNextionUpdater::uploadViaUART(const std::string& port, FILE* file, long fi
 			n = serial.write(buffer, (unsigned int)count);
 		}
 
+		serial.drain();
+
 		ret = waitForResponse(serial, 500U, true);
 		if (!ret) {
 			LogInfo("No response to a data upload");
@@ -290,6 +298,7 @@ bool CNextionUpdater::uploadViaMQTT(FILE* file, long fileSize)
 	char command[100U];
 	::sprintf(command, "whmi-wri %ld,9600,0\xFF\xFF\xFF", fileSize);
 	m_msp->write((unsigned char*)command, (unsigned int)::strlen(command));
+	m_msp->drain();
 
 	CUtils::dump(1U, "Nextion command", (unsigned char*)command, (unsigned int)::strlen(command));
 
@@ -309,6 +318,7 @@ bool CNextionUpdater::uploadViaMQTT(FILE* file, long fileSize)
 
 	while (count > 0U) {
 		m_msp->write(buffer, (unsigned int)count);
+		m_msp->drain();
 
 		ret = waitForResponse(*m_msp, 4000U, true);
 		if (!ret) {
@@ -381,8 +391,7 @@ void CNextionUpdater::onDisplay(const unsigned char* data, unsigned int length)
 {
 	assert(data != nullptr);
 	assert(length > 0U);
-	assert(driver != nullptr);
 
-	driver->readDisplay(data, length);
+	readDisplay(data, length);
 }
 
@@ -47,7 +47,7 @@ private:
 
 	void readDisplay(const unsigned char* data, unsigned int length);
 
-	static void onDisplay(const unsigned char* data, unsigned int length);
+	void onDisplay(const unsigned char* data, unsigned int length);
 };
 
 #endif
@@ -0,0 +1,111 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Poller.h"
+#include "Thread.h"
+#include "Log.h"
+
+#include <cassert>
+
+#if defined(_WIN32) || defined(_WIN64)
+
+CPoller::CPoller()
+{
+}
+
+CPoller::~CPoller()
+{
+}
+
+void CPoller::reset()
+{
+}
+
+void CPoller::add(int fd, bool write)
+{
+}
+
+int CPoller::wait(unsigned int ms)
+{
+	// Serial handles cannot be waited on alongside sockets, so fall back
+	// to the old fixed poll interval.
+	if (ms > 10U)
+		ms = 10U;
+
+	if (ms > 0U)
+		CThread::sleep(ms);
+
+	return 0;
+}
+
+#else
+
+#include <cerrno>
+
+CPoller::CPoller() :
+m_fds()
+{
+	m_fds.reserve(5U);
+}
+
+CPoller::~CPoller()
+{
+}
+
+void CPoller::reset()
+{
+	m_fds.clear();
+}
+
+void CPoller::add(int fd, bool write)
+{
+	if (fd < 0)
+		return;
+
+	for (auto& it : m_fds) {
+		if (it.fd == fd) {
+			if (write)
+				it.events |= POLLOUT;
+			return;
+		}
+	}
+
+	pollfd pfd;
+	pfd.fd      = fd;
+	pfd.events  = write ? (POLLIN | POLLOUT) : POLLIN;
+	pfd.revents = 0;
+
+	m_fds.push_back(pfd);
+}
+
+int CPoller::wait(unsigned int ms)
+{
+	int n = ::poll(m_fds.data(), nfds_t(m_fds.size()), int(ms));
+	if (n < 0) {
+		// A signal has arrived, let the caller look at its flags
+		if (errno == EINTR)
+			return 0;
+
+		LogError("Error from poll(), errno=%d", errno);
+		return -1;
+	}
+
+	return n;
+}
+
+#endif
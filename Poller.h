@@ -0,0 +1,51 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(POLLER_H)
+#define	POLLER_H
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <poll.h>
+#endif
+
+#include <vector>
+
+class CPoller
+{
+public:
+	CPoller();
+	~CPoller();
+
+	// The set of descriptors is rebuilt before every wait, sockets can be
+	// closed and reopened underneath us (MQTT reconnects) without any
+	// stale registrations being left behind.
+	void reset();
+
+	void add(int fd, bool write = false);
+
+	// Wait until one of the descriptors is ready or the timeout expires,
+	// returns the number of ready descriptors, 0 on timeout, or -1 on error.
+	int  wait(unsigned int ms);
+
+private:
+#if !defined(_WIN32) && !defined(_WIN64)
+	std::vector<pollfd> m_fds;
+#endif
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Replay.h"
+#include "Capture.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+CReplay::CReplay(const std::string& fileName) :
+m_fileName(fileName),
+m_fp(nullptr),
+m_data(nullptr),
+m_time(0U),
+m_topic(0U),
+m_length(0U)
+{
+	m_data = new unsigned char[CAPTURE_MAX_LENGTH];
+}
+
+CReplay::~CReplay()
+{
+	delete[] m_data;
+}
+
+bool CReplay::open()
+{
+	m_fp = ::fopen(m_fileName.c_str(), "rb");
+	if (m_fp == nullptr) {
+		LogError("Cannot open the replay file - %s", m_fileName.c_str());
+		return false;
+	}
+
+	char magic[CAPTURE_MAGIC_LENGTH];
+	if (::fread(magic, 1U, CAPTURE_MAGIC_LENGTH, m_fp) != CAPTURE_MAGIC_LENGTH || ::memcmp(magic, CAPTURE_MAGIC, CAPTURE_MAGIC_LENGTH) != 0) {
+		LogError("%s is not a capture file", m_fileName.c_str());
+		::fclose(m_fp);
+		m_fp = nullptr;
+		return false;
+	}
+
+	LogInfo("Replaying from %s", m_fileName.c_str());
+
+	return true;
+}
+
+bool CReplay::read()
+{
+	if (m_fp == nullptr)
+		return false;
+
+	unsigned char header[CAPTURE_HEADER_LENGTH];
+	if (::fread(header, 1U, CAPTURE_HEADER_LENGTH, m_fp) != CAPTURE_HEADER_LENGTH)
+		return false;
+
+	m_time   = (header[0U] << 0) | (header[1U] << 8) | (header[2U] << 16) | ((unsigned int)header[3U] << 24);
+	m_topic  = header[4U];
+	m_length = (header[5U] << 0) | (header[6U] << 8) | (header[7U] << 16) | ((unsigned int)header[8U] << 24);
+
+	if (m_length > CAPTURE_MAX_LENGTH) {
+		LogError("Invalid record length of %u in %s", m_length, m_fileName.c_str());
+		return false;
+	}
+
+	if (::fread(m_data, 1U, m_length, m_fp) != m_length) {
+		LogError("Truncated record in %s", m_fileName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+unsigned int CReplay::getTime() const
+{
+	return m_time;
+}
+
+unsigned char CReplay::getTopic() const
+{
+	return m_topic;
+}
+
+const unsigned char* CReplay::getData() const
+{
+	return m_data;
+}
+
+unsigned int CReplay::getLength() const
+{
+	return m_length;
+}
+
+void CReplay::close()
+{
+	if (m_fp == nullptr)
+		return;
+
+	::fclose(m_fp);
+	m_fp = nullptr;
+}
@@ -0,0 +1,52 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(REPLAY_H)
+#define	REPLAY_H
+
+#include <string>
+#include <cstdio>
+
+// Reads back a file written by CCapture, one record at a time
+class CReplay {
+public:
+	CReplay(const std::string& fileName);
+	~CReplay();
+
+	bool open();
+
+	// Loads the next record, returns false at the end of the file
+	bool read();
+
+	unsigned int         getTime() const;
+	unsigned char        getTopic() const;
+	const unsigned char* getData() const;
+	unsigned int         getLength() const;
+
+	void close();
+
+private:
+	std::string    m_fileName;
+	FILE*          m_fp;
+	unsigned char* m_data;
+	unsigned int   m_time;
+	unsigned char  m_topic;
+	unsigned int   m_length;
+};
+
+#endif
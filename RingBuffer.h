@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2006-2009,2012,2013,2015,2016,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2006-2009,2012,2013,2015,2016,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -24,11 +24,17 @@
 #include <cstdio>
 #include <cassert>
 #include <cstring>
+#include <atomic>
 
+// A single producer, single consumer ring buffer. The producer may call
+// addData() and the consumer getData(), peek(), span(), skip() and clear()
+// from different threads without a lock. The capacity is rounded up to a
+// power of two, and T must be safe to copy with memcpy().
 template<class T> class CRingBuffer {
 public:
 	CRingBuffer(unsigned int length, const char* name) :
-	m_length(length),
+	m_length(1U),
+	m_mask(0U),
 	m_name(name),
 	m_buffer(nullptr),
 	m_iPtr(0U),
@@ -37,7 +43,11 @@ public:
 		assert(length > 0U);
 		assert(name != nullptr);
 
-		m_buffer = new T[length];
+		while (m_length < length)
+			m_length <<= 1;
+		m_mask = m_length - 1U;
+
+		m_buffer = new T[m_length];
 
 		::memset(m_buffer, 0x00, m_length * sizeof(T));
 	}
@@ -49,106 +59,157 @@ public:
 
 	bool addData(const T* buffer, unsigned int nSamples)
 	{
-		if (nSamples >= freeSpace()) {
-			LogError("%s buffer overflow, clearing the buffer. (%u >= %u)", m_name, nSamples, freeSpace());
-			clear();
+		unsigned int iPtr = m_iPtr.load(std::memory_order_relaxed);
+		unsigned int oPtr = m_oPtr.load(std::memory_order_acquire);
+
+		// The producer cannot empty the buffer, so the new data is dropped
+		unsigned int space = m_length - (iPtr - oPtr);
+		if (nSamples > space) {
+			LogError("%s buffer overflow, dropping the data. (%u > %u)", m_name, nSamples, space);
 			return false;
 		}
 
-		for (unsigned int i = 0U; i < nSamples; i++) {
-			m_buffer[m_iPtr++] = buffer[i];
+		copyIn(iPtr, buffer, nSamples);
 
-			if (m_iPtr == m_length)
-				m_iPtr = 0U;
-		}
+		m_iPtr.store(iPtr + nSamples, std::memory_order_release);
 
 		return true;
 	}
 
 	bool getData(T* buffer, unsigned int nSamples)
 	{
-		if (dataSize() < nSamples) {
-			LogError("**** Underflow in %s ring buffer, %u < %u", m_name, dataSize(), nSamples);
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+
+		if ((iPtr - oPtr) < nSamples) {
+			LogError("**** Underflow in %s ring buffer, %u < %u", m_name, iPtr - oPtr, nSamples);
 			return false;
 		}
 
-		for (unsigned int i = 0U; i < nSamples; i++) {
-			buffer[i] = m_buffer[m_oPtr++];
+		copyOut(oPtr, buffer, nSamples);
 
-			if (m_oPtr == m_length)
-				m_oPtr = 0U;
-		}
+		m_oPtr.store(oPtr + nSamples, std::memory_order_release);
 
 		return true;
 	}
 
-	bool peek(T* buffer, unsigned int nSamples)
+	bool peek(T* buffer, unsigned int nSamples) const
 	{
-		if (dataSize() < nSamples) {
-			LogError("**** Underflow peek in %s ring buffer, %u < %u", m_name, dataSize(), nSamples);
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+
+		if ((iPtr - oPtr) < nSamples) {
+			LogError("**** Underflow peek in %s ring buffer, %u < %u", m_name, iPtr - oPtr, nSamples);
 			return false;
 		}
 
-		unsigned int ptr = m_oPtr;
-		for (unsigned int i = 0U; i < nSamples; i++) {
-			buffer[i] = m_buffer[ptr++];
+		copyOut(oPtr, buffer, nSamples);
+
+		return true;
+	}
+
+	// Returns the length of the data that can be read in place from data,
+	// this may be less than dataSize() where the data wraps around
+	unsigned int span(const T*& data) const
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
+
+		unsigned int offset = oPtr & m_mask;
+		unsigned int len    = iPtr - oPtr;
+
+		if (len > (m_length - offset))
+			len = m_length - offset;
+
+		data = m_buffer + offset;
+
+		return len;
+	}
+
+	bool skip(unsigned int nSamples)
+	{
+		unsigned int oPtr = m_oPtr.load(std::memory_order_relaxed);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
 
-			if (ptr == m_length)
-				ptr = 0U;
+		if ((iPtr - oPtr) < nSamples) {
+			LogError("**** Underflow skip in %s ring buffer, %u < %u", m_name, iPtr - oPtr, nSamples);
+			return false;
 		}
 
+		m_oPtr.store(oPtr + nSamples, std::memory_order_release);
+
 		return true;
 	}
 
 	void clear()
 	{
-		m_iPtr = 0U;
-		m_oPtr = 0U;
-
-		::memset(m_buffer, 0x00, m_length * sizeof(T));
+		m_oPtr.store(m_iPtr.load(std::memory_order_acquire), std::memory_order_release);
 	}
 
 	unsigned int freeSpace() const
 	{
-		unsigned int len = m_length;
+		return m_length - dataSize();
+	}
 
-		if (m_oPtr > m_iPtr)
-			len = m_oPtr - m_iPtr;
-		else if (m_iPtr > m_oPtr)
-			len = m_length - (m_iPtr - m_oPtr);
+	unsigned int dataSize() const
+	{
+		// Seen from a third thread the input pointer may have moved on
+		unsigned int oPtr = m_oPtr.load(std::memory_order_acquire);
+		unsigned int iPtr = m_iPtr.load(std::memory_order_acquire);
 
+		unsigned int len = iPtr - oPtr;
 		if (len > m_length)
-			len = 0U;
+			len = m_length;
 
 		return len;
 	}
 
-	unsigned int dataSize() const
-	{
-		return m_length - freeSpace();
-	}
-
 	bool hasSpace(unsigned int length) const
 	{
-		return freeSpace() > length;
+		return freeSpace() >= length;
 	}
 
 	bool hasData() const
 	{
-		return m_oPtr != m_iPtr;
+		return dataSize() > 0U;
 	}
 
 	bool isEmpty() const
 	{
-		return m_oPtr == m_iPtr;
+		return dataSize() == 0U;
 	}
 
 private:
 	unsigned int m_length;
+	unsigned int m_mask;
 	const char*  m_name;
 	T*           m_buffer;
-	unsigned int m_iPtr;
-	unsigned int m_oPtr;
+	std::atomic<unsigned int> m_iPtr;
+	std::atomic<unsigned int> m_oPtr;
+
+	// The pointers run freely and are masked on use, the copy is split in
+	// two where it wraps around the end of the buffer
+	void copyIn(unsigned int ptr, const T* buffer, unsigned int nSamples)
+	{
+		unsigned int offset = ptr & m_mask;
+		unsigned int first  = m_length - offset;
+		if (first > nSamples)
+			first = nSamples;
+
+		::memcpy(m_buffer + offset, buffer, first * sizeof(T));
+		::memcpy(m_buffer, buffer + first, (nSamples - first) * sizeof(T));
+	}
+
+	void copyOut(unsigned int ptr, T* buffer, unsigned int nSamples) const
+	{
+		unsigned int offset = ptr & m_mask;
+		unsigned int first  = m_length - offset;
+		if (first > nSamples)
+			first = nSamples;
+
+		::memcpy(buffer, m_buffer + offset, first * sizeof(T));
+		::memcpy(buffer + first, m_buffer, (nSamples - first) * sizeof(T));
+	}
 };
 
 #endif
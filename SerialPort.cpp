@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2016 by Jonathan Naylor G4KLX
+*   Copyright (C) 2016,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -17,7 +17,60 @@
 */
 
 #include "SerialPort.h"
+#include "Metrics.h"
 
 ISerialPort::~ISerialPort()
 {
 }
+
+int ISerialPort::readAvailable(unsigned char* buffer, unsigned int length)
+{
+	// A single byte read never waits for more to arrive
+	unsigned int n = 0U;
+	while (n < length) {
+		int ret = read(buffer + n, 1U);
+		if (ret < 0)
+			return (n > 0U) ? int(n) : ret;
+		if (ret == 0)
+			break;
+
+		n++;
+	}
+
+	return int(n);
+}
+
+bool ISerialPort::flush()
+{
+	return true;
+}
+
+bool ISerialPort::drain()
+{
+	return true;
+}
+
+bool ISerialPort::wantWrite() const
+{
+	return false;
+}
+
+unsigned long long ISerialPort::getReadTime() const
+{
+	return ::MetricsNow();
+}
+
+int ISerialPort::getFD() const
+{
+	return -1;
+}
+
+unsigned int ISerialPort::getSpeed() const
+{
+	return 0U;
+}
+
+bool ISerialPort::setSpeed(unsigned int)
+{
+	return false;
+}
@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2016 by Jonathan Naylor G4KLX
+*   Copyright (C) 2016,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -27,10 +27,34 @@ public:
 
 	virtual int read(unsigned char* buffer, unsigned int length) = 0;
 
+	// Returns whatever is waiting, up to length bytes, without blocking
+	virtual int readAvailable(unsigned char* buffer, unsigned int length);
+
 	virtual int write(const unsigned char* buffer, unsigned int length) = 0;
 
+	// Passes on as much of any held back output as can go without blocking
+	virtual bool flush();
+
+	// Waits until all held back output has gone
+	virtual bool drain();
+
+	// True when output is being held back for the port to become writable
+	virtual bool wantWrite() const;
+
+	// The MetricsNow() time at which the data last read arrived
+	virtual unsigned long long getReadTime() const;
+
 	virtual void close() = 0;
 
+	// The descriptor to wait on for incoming data, or -1 if there is none
+	virtual int getFD() const;
+
+	// The line speed, or 0 if the port has none that can be changed
+	virtual unsigned int getSpeed() const;
+
+	// Changes the line speed, the port stays open even if this fails
+	virtual bool setSpeed(unsigned int speed);
+
 private:
 };
 
@@ -104,7 +104,7 @@ m_serial(serial),
 m_brightness(brightness),
 m_mode(MODE_IDLE),
 m_refresh(false),
-m_refreshTimer(1000U, 0U, REFRESH_PERIOD),
+m_refreshTimer(m_timers, REFRESH_PERIOD, [this]() { refreshDisplay(); }),
 m_lineBuf(nullptr),
 m_screenLayout(screenLayout)
 {
@@ -137,8 +137,6 @@ bool CTFTSurenoo::open()
 	clearScreen(static_cast<unsigned char>(LcdColour::BG_COLOUR));
 	setIdle();
 
-	m_refreshTimer.start();
-
 	return true;
 }
 
@@ -352,14 +350,23 @@ void CTFTSurenoo::close()
 	delete m_serial;
 }
 
-void CTFTSurenoo::clockInt(unsigned int ms)
+int CTFTSurenoo::getFD() const
 {
-	m_refreshTimer.clock(ms);	// renew timer status 
+	// Nothing is read back, the port is only watched while output waits
+	if (m_serial->wantWrite())
+		return m_serial->getFD();
 
-	if (m_refreshTimer.isRunning() && m_refreshTimer.hasExpired()) {
-		refreshDisplay();
-		m_refreshTimer.start();	// reset timer, wait for next period
-	}
+	return -1;
+}
+
+bool CTFTSurenoo::wantWrite() const
+{
+	return m_serial->wantWrite();
+}
+
+void CTFTSurenoo::clockInt()
+{
+	m_serial->flush();
 }
 
 void CTFTSurenoo::setLineBuffer(char *buf, const char *text, int maxchar)
@@ -370,6 +377,11 @@ void CTFTSurenoo::setLineBuffer(char *buf, const char *text, int maxchar)
 		buf[i] = text[i];
 	buf[i] = '\0';
 
+	// The first change since the last refresh starts the period, so the
+	// timer only wakes us up when there is something to draw
+	if (!m_refresh)
+		m_refreshTimer.start();
+
 	m_refresh = true;
 }
 
@@ -399,6 +411,7 @@ void CTFTSurenoo::refreshDisplay()
 	setBrightness(m_brightness);
 	setBackground(static_cast<unsigned char>(LcdColour::BG_COLOUR));
 	m_serial->write((unsigned char*)m_temp, (unsigned int)::strlen(m_temp));
+	m_serial->drain();
 	CThread::sleep(5);
 
 	// clear display
@@ -427,6 +440,9 @@ void CTFTSurenoo::refreshDisplay()
 	::snprintf(m_temp, sizeof(m_temp), STR_CRLF);
 	m_serial->write((unsigned char*)m_temp, (unsigned int)::strlen(m_temp));
 
+	// the whole frame goes out in as few writes as the port allows
+	m_serial->flush();
+
 	m_refresh = false;
 }
 
@@ -434,6 +450,7 @@ void CTFTSurenoo::lcdReset()
 {
 	::snprintf(m_temp, sizeof(m_temp), "RESET;" STR_CRLF);
 	m_serial->write((unsigned char*)m_temp, (unsigned int)::strlen(m_temp));
+	m_serial->drain();
 	CThread::sleep(250);	// document says 230ms
 }
 
@@ -443,6 +460,7 @@ void CTFTSurenoo::clearScreen(unsigned char colour)
 
 	::snprintf(m_temp, sizeof(m_temp), "CLR(%d);" STR_CRLF, colour);
 	m_serial->write((unsigned char*)m_temp, (unsigned int)::strlen(m_temp));
+	m_serial->drain();
 	CThread::sleep(100);	// at least 60ms (@240x320 panel)
 }
 
@@ -36,6 +36,10 @@ public:
 
 	virtual void close();
 
+	virtual int getFD() const;
+
+	virtual bool wantWrite() const;
+
 protected:
 	virtual void setIdleInt();
 	virtual void setErrorInt();
@@ -66,7 +70,9 @@ protected:
 	virtual void writeCWInt();
 	virtual void clearCWInt();
 
-	virtual void clockInt(unsigned int ms);
+	virtual void clockInt();
+
+	void refreshDisplay();
 
 private:
 	std::string   m_callsign;
@@ -84,7 +90,6 @@ private:
 	void setLineBuffer(char *buf, const char *text, int maxchar);
 	void setModeLine(const char *text);
 	void setStatusLine(unsigned int line, const char *text);
-	void refreshDisplay();
 
 	void lcdReset();
 	void clearScreen(unsigned char colour);
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2009,2010,2015 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2009,2010,2015,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -18,51 +18,83 @@
 
 #include "Timer.h"
 
-#include <cstdio>
 #include <cassert>
 
-CTimer::CTimer(unsigned int ticksPerSec, unsigned int secs, unsigned int msecs) :
-m_ticksPerSec(ticksPerSec),
-m_timeout(0U),
-m_timer(0U)
+CTimer::CTimer(CTimerService& service, unsigned int ms, const TimerCallback& callback) :
+m_service(service),
+m_timeout(ms),
+m_callback(callback),
+m_running(false),
+m_deadline(0ULL),
+m_id(0U)
 {
-	assert(ticksPerSec > 0U);
-
-	if (secs > 0U || msecs > 0U) {
-		// m_timeout = ((secs * 1000U + msecs) * m_ticksPerSec) / 1000U + 1U;
-		unsigned long long temp = (secs * 1000ULL + msecs) * m_ticksPerSec;
-		m_timeout = (unsigned int)(temp / 1000ULL + 1ULL);
-	}
 }
 
 CTimer::~CTimer()
 {
+	stop();
 }
 
-void CTimer::setTimeout(unsigned int secs, unsigned int msecs)
+void CTimer::setTimeout(unsigned int ms)
 {
-	if (secs > 0U || msecs > 0U) {
-		// m_timeout = ((secs * 1000U + msecs) * m_ticksPerSec) / 1000U + 1U;
-		unsigned long long temp = (secs * 1000ULL + msecs) * m_ticksPerSec;
-		m_timeout = (unsigned int)(temp / 1000ULL + 1ULL);
-	} else {
-		m_timeout = 0U;
-		m_timer = 0U;
-	}
+	m_timeout = ms;
+
+	if (ms == 0U)
+		stop();
 }
 
 unsigned int CTimer::getTimeout() const
 {
-	if (m_timeout == 0U)
+	return m_timeout;
+}
+
+unsigned int CTimer::getRemaining() const
+{
+	if (!m_running)
+		return 0U;
+
+	unsigned long long now = CTimerService::now();
+	if (now >= m_deadline)
 		return 0U;
 
-	return (m_timeout - 1U) / m_ticksPerSec;
+	return (unsigned int)(m_deadline - now);
 }
 
-unsigned int CTimer::getTimer() const
+void CTimer::start()
 {
-	if (m_timer == 0U)
-		return 0U;
+	if (m_timeout == 0U)
+		return;
+
+	if (m_id != 0U)
+		m_service.cancel(m_id);
+
+	m_running  = true;
+	m_deadline = CTimerService::now() + m_timeout;
+	m_id       = m_service.add(m_timeout, [this]() { expired(); });
+}
+
+void CTimer::stop()
+{
+	if (m_id != 0U) {
+		m_service.cancel(m_id);
+		m_id = 0U;
+	}
+
+	m_running = false;
+}
+
+bool CTimer::hasExpired() const
+{
+	if (!m_running)
+		return false;
+
+	return CTimerService::now() >= m_deadline;
+}
+
+void CTimer::expired()
+{
+	m_id = 0U;
 
-	return (m_timer - 1U) / m_ticksPerSec;
+	if (m_callback)
+		m_callback();
 }
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2009,2010,2011,2014 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2009,2010,2011,2014,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,71 +19,50 @@
 #ifndef	Timer_H
 #define	Timer_H
 
+#include "TimerService.h"
+
+// A restartable timeout on a CTimerService. Once expired it stays running
+// until it is stopped or started again, the callback if any is called from
+// CTimerService::run() when it expires.
 class CTimer {
 public:
-	CTimer(unsigned int ticksPerSec, unsigned int secs = 0U, unsigned int msecs = 0U);
+	CTimer(CTimerService& service, unsigned int ms, const TimerCallback& callback = TimerCallback());
 	~CTimer();
 
-	void setTimeout(unsigned int secs, unsigned int msecs = 0U);
+	void setTimeout(unsigned int ms);
 
 	unsigned int getTimeout() const;
-	unsigned int getTimer() const;
-
-	unsigned int getRemaining()
-	{
-		if (m_timeout == 0U || m_timer == 0U)
-			return 0U;
-
-		if (m_timer >= m_timeout)
-			return 0U;
 
-		return (m_timeout - m_timer) / m_ticksPerSec;
-	}
+	// The ms left to run, 0 if expired or stopped
+	unsigned int getRemaining() const;
 
-	bool isRunning()
+	bool isRunning() const
 	{
-		return m_timer > 0U;
+		return m_running;
 	}
 
-	void start(unsigned int secs, unsigned int msecs = 0U)
+	void start(unsigned int ms)
 	{
-		setTimeout(secs, msecs);
+		setTimeout(ms);
 
 		start();
 	}
 
-	void start()
-	{
-		if (m_timeout > 0U)
-			m_timer = 1U;
-	}
-
-	void stop()
-	{
-		m_timer = 0U;
-	}
-
-	bool hasExpired()
-	{
-		if (m_timeout == 0U || m_timer == 0U)
-			return false;
+	void start();
 
-		if (m_timer >= m_timeout)
-			return true;
+	void stop();
 
-		return false;
-	}
-
-	void clock(unsigned int ticks = 1U)
-	{
-		if (m_timer > 0U && m_timeout > 0U)
-			m_timer += ticks;
-	}
+	bool hasExpired() const;
 
 private:
-	unsigned int m_ticksPerSec;
-	unsigned int m_timeout;
-	unsigned int m_timer;
+	CTimerService&     m_service;
+	unsigned int       m_timeout;
+	TimerCallback      m_callback;
+	bool               m_running;
+	unsigned long long m_deadline;
+	unsigned int       m_id;
+
+	void expired();
 };
 
 #endif
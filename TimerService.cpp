@@ -0,0 +1,119 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "TimerService.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+
+CTimerService::CTimerService() :
+m_heap(),
+m_callbacks(),
+m_id(0U)
+{
+}
+
+CTimerService::~CTimerService()
+{
+}
+
+unsigned int CTimerService::add(unsigned int ms, const TimerCallback& callback)
+{
+	assert(callback);
+
+	if (++m_id == 0U)
+		m_id = 1U;
+
+	CEntry entry;
+	entry.m_deadline = now() + ms;
+	entry.m_id       = m_id;
+
+	m_heap.push_back(entry);
+	std::push_heap(m_heap.begin(), m_heap.end(), later);
+
+	m_callbacks[m_id] = callback;
+
+	return m_id;
+}
+
+void CTimerService::cancel(unsigned int id)
+{
+	m_callbacks.erase(id);
+}
+
+void CTimerService::run()
+{
+	unsigned long long time = now();
+
+	while (!m_heap.empty() && m_heap.front().m_deadline <= time) {
+		unsigned int id = m_heap.front().m_id;
+		pop();
+
+		auto it = m_callbacks.find(id);
+		if (it == m_callbacks.end())
+			continue;
+
+		// The callback may well add or cancel timers of its own
+		TimerCallback callback = it->second;
+		m_callbacks.erase(it);
+
+		callback();
+	}
+}
+
+unsigned int CTimerService::nextDeadline(unsigned int max)
+{
+	prune();
+
+	if (m_heap.empty())
+		return max;
+
+	unsigned long long time     = now();
+	unsigned long long deadline = m_heap.front().m_deadline;
+	if (deadline <= time)
+		return 0U;
+
+	if ((deadline - time) < max)
+		return (unsigned int)(deadline - time);
+
+	return max;
+}
+
+unsigned long long CTimerService::now()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void CTimerService::pop()
+{
+	std::pop_heap(m_heap.begin(), m_heap.end(), later);
+	m_heap.pop_back();
+}
+
+void CTimerService::prune()
+{
+	while (!m_heap.empty() && m_callbacks.count(m_heap.front().m_id) == 0U)
+		pop();
+}
+
+bool CTimerService::later(const CEntry& a, const CEntry& b)
+{
+	return a.m_deadline > b.m_deadline;
+}
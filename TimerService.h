@@ -0,0 +1,69 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#if !defined(TIMERSERVICE_H)
+#define	TIMERSERVICE_H
+
+#include <unordered_map>
+#include <functional>
+#include <vector>
+
+typedef std::function<void()> TimerCallback;
+
+// Calls back once each deadline on a monotonic clock has passed, and says
+// how long it is until the next one so that the caller can sleep until
+// then. Not thread safe, each thread that drives timers needs its own.
+class CTimerService {
+public:
+	CTimerService();
+	~CTimerService();
+
+	// Returns an id for cancel(), which is never 0
+	unsigned int add(unsigned int ms, const TimerCallback& callback);
+
+	void cancel(unsigned int id);
+
+	// Calls back everything that is due
+	void run();
+
+	// The ms until run() next has work to do, no more than max
+	unsigned int nextDeadline(unsigned int max);
+
+	// Milliseconds on the monotonic clock
+	static unsigned long long now();
+
+private:
+	struct CEntry {
+		unsigned long long m_deadline;
+		unsigned int       m_id;
+	};
+
+	// A heap with the earliest deadline at the front. Cancelled entries
+	// stay in it until they reach the front.
+	std::vector<CEntry> m_heap;
+	std::unordered_map<unsigned int, TimerCallback> m_callbacks;
+	unsigned int        m_id;
+
+	void pop();
+	void prune();
+
+	static bool later(const CEntry& a, const CEntry& b);
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2002-2004,2007-2011,2013,2014-2017,2019,2020,2021,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2002-2004,2007-2011,2013,2014-2017,2019,2020,2021,2025,2026 by Jonathan Naylor G4KLX
  *   Copyright (C) 1999-2001 by Thomas Sailor HB9JNX
  *
  *   This program is free software; you can redistribute it and/or modify
@@ -18,6 +18,8 @@
  */
 
 #include "UARTController.h"
+#include "UARTSpeed.h"
+#include "Metrics.h"
 #include "Log.h"
 
 #include <cstring>
@@ -30,28 +32,47 @@
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <cerrno>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <termios.h>
+#if defined(__linux__)
+#include <linux/serial.h>
+#endif
+
+// Writes at least this long go straight out, as does the output held
+// back once it reaches this
+const unsigned int FLUSH_LENGTH = 256U;
+
+// The most output held back before a write has to wait for the port
+const unsigned int OUTPUT_LENGTH = 16384U;
+
+// How long drain() waits for the port to take the output, in ms
+const int DRAIN_TIMEOUT = 2000;
 #endif
 
 
 #if defined(_WIN32) || defined(_WIN64)
 
-CUARTController::CUARTController(const std::string& device, unsigned int speed, bool assertRTS) :
+CUARTController::CUARTController(const std::string& device, unsigned int speed, bool assertRTS, bool lowLatency) :
 m_device(device),
 m_speed(speed),
 m_assertRTS(assertRTS),
+m_lowLatency(lowLatency),
+m_readTime(0ULL),
 m_handle(INVALID_HANDLE_VALUE)
 {
 	assert(!device.empty());
 }
 
-CUARTController::CUARTController(unsigned int speed, bool assertRTS) :
+CUARTController::CUARTController(unsigned int speed, bool assertRTS, bool lowLatency) :
 m_device(),
 m_speed(speed),
 m_assertRTS(assertRTS),
+m_lowLatency(lowLatency),
+m_readTime(0ULL),
 m_handle(INVALID_HANDLE_VALUE)
 {
 }
@@ -162,6 +183,11 @@ int CUARTController::read(unsigned char* buffer, unsigned int length)
 	return int(length);
 }
 
+int CUARTController::readAvailable(unsigned char* buffer, unsigned int length)
+{
+	return readNonblock(buffer, length);
+}
+
 int CUARTController::readNonblock(unsigned char* buffer, unsigned int length)
 {
 	assert(m_handle != INVALID_HANDLE_VALUE);
@@ -191,6 +217,9 @@ int CUARTController::readNonblock(unsigned char* buffer, unsigned int length)
 		return -1;
 	}
 
+	if (bytes > 0UL)
+		m_readTime = ::MetricsNow();
+
 	return int(bytes);
 }
 
@@ -215,6 +244,8 @@ int CUARTController::write(const unsigned char* buffer, unsigned int length)
 		ptr += bytes;
 	}
 
+	::MetricsCount(METRIC_COUNT::UART_BYTES, length);
+
 	return int(length);
 }
 
@@ -226,22 +257,64 @@ void CUARTController::close()
 	m_handle = INVALID_HANDLE_VALUE;
 }
 
+int CUARTController::getFD() const
+{
+	return -1;
+}
+
+bool CUARTController::setSpeed(unsigned int speed)
+{
+	assert(m_handle != INVALID_HANDLE_VALUE);
+
+	if (speed == m_speed)
+		return true;
+
+	DCB dcb;
+	if (::GetCommState(m_handle, &dcb) == 0) {
+		LogError("Cannot get the attributes for %s, err=%04lx", m_device.c_str(), ::GetLastError());
+		return false;
+	}
+
+	DWORD oldSpeed = dcb.BaudRate;
+
+	dcb.BaudRate = DWORD(speed);
+
+	if (::SetCommState(m_handle, &dcb) == 0) {
+		LogWarning("Cannot set %s to %u baud, err=%04lx", m_device.c_str(), speed, ::GetLastError());
+		dcb.BaudRate = oldSpeed;
+		::SetCommState(m_handle, &dcb);
+		return false;
+	}
+
+	m_speed = speed;
+
+	return true;
+}
+
 #else
 
-CUARTController::CUARTController(const std::string& device, unsigned int speed, bool assertRTS) :
+CUARTController::CUARTController(const std::string& device, unsigned int speed, bool assertRTS, bool lowLatency) :
 m_device(device),
 m_speed(speed),
 m_assertRTS(assertRTS),
-m_fd(-1)
+m_lowLatency(lowLatency),
+m_readTime(0ULL),
+m_fd(-1),
+m_output(),
+m_outputPtr(0U)
 {
 	assert(!device.empty());
 }
 
-CUARTController::CUARTController(unsigned int speed, bool assertRTS) :
+CUARTController::CUARTController(unsigned int speed, bool assertRTS, bool lowLatency) :
 m_device(),
 m_speed(speed),
 m_assertRTS(assertRTS),
-m_fd(-1)
+m_lowLatency(lowLatency),
+m_readTime(0ULL),
+m_fd(-1),
+m_output(),
+m_outputPtr(0U)
 {
 }
 
@@ -254,7 +327,7 @@ bool CUARTController::open()
 	assert(m_fd == -1);
 
 #if defined(__APPLE__)
-	m_fd = ::open(m_device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK); /*open in block mode under OSX*/
+	m_fd = ::open(m_device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
 #else
 	m_fd = ::open(m_device.c_str(), O_RDWR | O_NOCTTY | O_NDELAY, 0);
 #endif
@@ -263,9 +336,11 @@ bool CUARTController::open()
 		return false;
 	}
 
-	if (::isatty(m_fd))
-		return setRaw();
-		
+	if (::isatty(m_fd) && !setRaw()) {
+		m_fd = -1;
+		return false;
+	}
+
 	return true;
 }
 
@@ -295,6 +370,52 @@ bool CUARTController::setRaw()
 	termios.c_cc[VTIME] = 10;
 #endif
 
+	if (!setLineSpeed(termios)) {
+		::close(m_fd);
+		return false;
+	}
+
+	// USB bridges otherwise hold received bytes back for their latency timer
+	if (m_lowLatency) {
+#if defined(__linux__) && defined(ASYNC_LOW_LATENCY)
+		serial_struct serial;
+		if (::ioctl(m_fd, TIOCGSERIAL, &serial) == 0) {
+			serial.flags |= ASYNC_LOW_LATENCY;
+			if (::ioctl(m_fd, TIOCSSERIAL, &serial) < 0)
+				LogWarning("Cannot set low latency mode for %s", m_device.c_str());
+		} else {
+			LogWarning("%s does not support low latency mode", m_device.c_str());
+		}
+#else
+		LogWarning("Low latency mode is not supported for %s", m_device.c_str());
+#endif
+	}
+
+	if (m_assertRTS) {
+		unsigned int y;
+		if (::ioctl(m_fd, TIOCMGET, &y) < 0) {
+			LogError("Cannot get the control attributes for %s", m_device.c_str());
+			::close(m_fd);
+			return false;
+		}
+
+		y |= TIOCM_RTS;
+
+		if (::ioctl(m_fd, TIOCMSET, &y) < 0) {
+			LogError("Cannot set the control attributes for %s", m_device.c_str());
+			::close(m_fd);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Sets the attributes, with the line running at m_speed
+bool CUARTController::setLineSpeed(termios& termios)
+{
+	bool known = true;
+
 #if !defined(B38400) || (B38400 != 38400)
 	switch (m_speed) {
 #if defined(B1200)
@@ -363,10 +484,27 @@ bool CUARTController::setRaw()
                         ::cfsetispeed(&termios, B500000);
                         break;
 #endif /*B500000*/
+#if defined(B576000)
+		case 576000U:
+			::cfsetospeed(&termios, B576000);
+			::cfsetispeed(&termios, B576000);
+			break;
+#endif /*B576000*/
+#if defined(B921600)
+		case 921600U:
+			::cfsetospeed(&termios, B921600);
+			::cfsetispeed(&termios, B921600);
+			break;
+#endif /*B921600*/
+#if defined(B1000000)
+		case 1000000U:
+			::cfsetospeed(&termios, B1000000);
+			::cfsetispeed(&termios, B1000000);
+			break;
+#endif /*B1000000*/
 		default:
-			LogError("Unsupported serial port speed - %u", m_speed);
-			::close(m_fd);
-			return false;
+			known = false;
+			break;
 	}
 #else
 	::cfsetospeed(&termios, m_speed);
@@ -375,30 +513,21 @@ bool CUARTController::setRaw()
 
 	if (::tcsetattr(m_fd, TCSANOW, &termios) < 0) {
 		LogError("Cannot set the attributes for %s", m_device.c_str());
-		::close(m_fd);
 		return false;
 	}
 
-	if (m_assertRTS) {
-		unsigned int y;
-		if (::ioctl(m_fd, TIOCMGET, &y) < 0) {
-			LogError("Cannot get the control attributes for %s", m_device.c_str());
-			::close(m_fd);
-			return false;
-		}
-
-		y |= TIOCM_RTS;
-
-		if (::ioctl(m_fd, TIOCMSET, &y) < 0) {
-			LogError("Cannot set the control attributes for %s", m_device.c_str());
-			::close(m_fd);
-			return false;
-		}
+	// termios2 takes any speed and tells us what the driver made of it,
+	// the table above is only needed where it is missing
+	unsigned int actual = ::UARTSetSpeed(m_fd, m_speed);
+	if (actual == 0U && !known) {
+		LogError("Unsupported serial port speed - %u", m_speed);
+		return false;
 	}
 
-#if defined(__APPLE__)
-	setNonblock(false);
-#endif
+	if (actual != 0U && actual != m_speed)
+		LogWarning("%s is running at %u baud, %u was asked for", m_device.c_str(), actual, m_speed);
+	else if (actual != 0U)
+		LogInfo("%s is running at %u baud", m_device.c_str(), actual);
 
 	return true;
 }
@@ -457,32 +586,39 @@ int CUARTController::read(unsigned char* buffer, unsigned int length)
 				}
 			}
 
-			if (len > 0)
+			if (len > 0) {
+				if (offset == 0U)
+					m_readTime = ::MetricsNow();
+
 				offset += len;
+			}
 		}
 	}
 
 	return length;
 }
 
-bool CUARTController::canWrite(){
-#if defined(__APPLE__)
-	fd_set wset;
-	FD_ZERO(&wset);
-	FD_SET(m_fd, &wset);
+int CUARTController::readAvailable(unsigned char* buffer, unsigned int length)
+{
+	assert(buffer != nullptr);
+	assert(m_fd != -1);
 
-	struct timeval timeo;
-	timeo.tv_sec  = 0;
-	timeo.tv_usec = 0;
+	if (length == 0U)
+		return 0;
 
-	int rc = ::select(m_fd + 1, nullptr, &wset, nullptr, &timeo);
-	if (rc > 0 && FD_ISSET(m_fd, &wset))
-		return true;
+	ssize_t len = ::read(m_fd, buffer, length);
+	if (len < 0) {
+		if (errno == EAGAIN)
+			return 0;
 
-	return false;
-#else
-	return true;
-#endif
+		LogError("Error from read(), errno=%d", errno);
+		return -1;
+	}
+
+	if (len > 0)
+		m_readTime = ::MetricsNow();
+
+	return int(len);
 }
 
 int CUARTController::write(const unsigned char* buffer, unsigned int length)
@@ -493,32 +629,198 @@ int CUARTController::write(const unsigned char* buffer, unsigned int length)
 	if (length == 0U)
 		return 0;
 
-	unsigned int ptr = 0U;
-	while (ptr < length) {
-		ssize_t n = 0U;
-		if (canWrite())
-			n = ::write(m_fd, buffer + ptr, length - ptr);
+	::MetricsCount(METRIC_COUNT::UART_BYTES, length);
+
+	unsigned int sent = 0U;
+
+	// A short write is only copied, it goes out with the rest of the
+	// output on the next flush
+	if (length >= FLUSH_LENGTH || (m_output.size() - m_outputPtr + length) >= FLUSH_LENGTH) {
+		if (!writeOut(buffer, length, sent))
+			return -1;
+	}
+
+	if (sent == length)
+		return int(length);
+
+	if ((m_output.size() - m_outputPtr + length - sent) > OUTPUT_LENGTH) {
+		if (!drain())
+			return -1;
+	}
+
+	m_output.insert(m_output.end(), buffer + sent, buffer + length);
+
+	return int(length);
+}
+
+bool CUARTController::flush()
+{
+	assert(m_fd != -1);
+
+	unsigned int sent = 0U;
+	return writeOut(nullptr, 0U, sent);
+}
+
+bool CUARTController::drain()
+{
+	assert(m_fd != -1);
+
+	while (m_outputPtr < m_output.size()) {
+		if (!flush())
+			return false;
+
+		if (m_outputPtr == m_output.size())
+			break;
+
+		pollfd pfd;
+		pfd.fd      = m_fd;
+		pfd.events  = POLLOUT;
+		pfd.revents = 0;
+
+		int n = ::poll(&pfd, 1, DRAIN_TIMEOUT);
+		if (n < 0 && errno != EINTR) {
+			LogError("Error from poll(), errno=%d", errno);
+			return false;
+		}
+
+		if (n == 0) {
+			LogWarning("%s is not taking any output, %u bytes dropped", m_device.c_str(), (unsigned int)(m_output.size() - m_outputPtr));
+			m_output.clear();
+			m_outputPtr = 0U;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CUARTController::wantWrite() const
+{
+	return m_outputPtr < m_output.size();
+}
+
+// Writes any held back output followed by the new data, in one call where
+// possible, and stops without waiting once the port is full
+bool CUARTController::writeOut(const unsigned char* buffer, unsigned int length, unsigned int& sent)
+{
+	sent = 0U;
+
+	for (;;) {
+		iovec iov[2U];
+		int count = 0;
+
+		unsigned int held = (unsigned int)(m_output.size() - m_outputPtr);
+		if (held > 0U) {
+			iov[count].iov_base = &m_output[m_outputPtr];
+			iov[count].iov_len  = held;
+			count++;
+		}
+
+		if (sent < length) {
+			iov[count].iov_base = (void*)(buffer + sent);
+			iov[count].iov_len  = length - sent;
+			count++;
+		}
+
+		if (count == 0)
+			break;
+
+		ssize_t n = ::writev(m_fd, iov, count);
 		if (n < 0) {
-			if (errno != EAGAIN) {
-				LogError("Error returned from write(), errno=%d", errno);
-				return -1;
-			}
+			if (errno == EINTR)
+				continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+
+			LogError("Error returned from writev(), errno=%d", errno);
+			return false;
 		}
 
-		if (n > 0)
-			ptr += n;
+		unsigned int written = (unsigned int)n;
+		if (written < held) {
+			m_outputPtr += written;
+		} else {
+			m_outputPtr += held;
+			sent += written - held;
+		}
+
+		if (written == 0U)
+			break;
 	}
 
-	return length;
+	// Only move the held back output down once most of it has gone
+	if (m_outputPtr == m_output.size()) {
+		m_output.clear();
+		m_outputPtr = 0U;
+	} else if (m_outputPtr > (m_output.size() / 2U)) {
+		m_output.erase(m_output.begin(), m_output.begin() + m_outputPtr);
+		m_outputPtr = 0U;
+	}
+
+	return true;
 }
 
 void CUARTController::close()
 {
 	assert(m_fd != -1);
 
+	drain();
+
 	::close(m_fd);
 	m_fd = -1;
 }
 
+int CUARTController::getFD() const
+{
+	return m_fd;
+}
+
+// The line speed is changed in place, the port stays open whatever happens
+bool CUARTController::setSpeed(unsigned int speed)
+{
+	assert(m_fd != -1);
+
+	if (speed == m_speed)
+		return true;
+
+	if (!::isatty(m_fd)) {
+		m_speed = speed;
+		return true;
+	}
+
+	termios old;
+	if (::tcgetattr(m_fd, &old) < 0) {
+		LogError("Cannot get the attributes for %s", m_device.c_str());
+		return false;
+	}
+
+	// The held back output belongs to the old speed
+	drain();
+
+	termios termios = old;
+	unsigned int oldSpeed = m_speed;
+
+	m_speed = speed;
+	if (setLineSpeed(termios))
+		return true;
+
+	LogWarning("Cannot set %s to %u baud, returning to %u baud", m_device.c_str(), speed, oldSpeed);
+
+	m_speed = oldSpeed;
+	::tcsetattr(m_fd, TCSANOW, &old);
+	::UARTSetSpeed(m_fd, oldSpeed);
+
+	return false;
+}
+
 #endif
 
+unsigned long long CUARTController::getReadTime() const
+{
+	return m_readTime;
+}
+
+unsigned int CUARTController::getSpeed() const
+{
+	return m_speed;
+}
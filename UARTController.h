@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2002-2004,2007-2009,2011-2013,2015-2017,2020,2021,2023 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2002-2004,2007-2009,2011-2013,2015-2017,2020,2021,2023,2026 by Jonathan Naylor G4KLX
  *   Copyright (C) 1999-2001 by Thomas Sailor HB9JNX
  *
  *   This program is free software; you can redistribute it and/or modify
@@ -26,42 +26,69 @@
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
+#else
+#include <vector>
+
+#include <termios.h>
 #endif
 
 class CUARTController : public ISerialPort {
 public:
-	CUARTController(const std::string& device, unsigned int speed, bool assertRTS = false);
+	CUARTController(const std::string& device, unsigned int speed, bool assertRTS = false, bool lowLatency = false);
 	virtual ~CUARTController();
 
 	virtual bool open();
 
 	virtual int read(unsigned char* buffer, unsigned int length);
 
+	virtual int readAvailable(unsigned char* buffer, unsigned int length);
+
 	virtual int write(const unsigned char* buffer, unsigned int length);
 
+#if !defined(_WIN32) && !defined(_WIN64)
+	virtual bool flush();
+
+	virtual bool drain();
+
+	virtual bool wantWrite() const;
+#endif
+
 	virtual void close();
 
+	virtual int getFD() const;
+
+	virtual unsigned int getSpeed() const;
+
+	virtual bool setSpeed(unsigned int speed);
+
+	virtual unsigned long long getReadTime() const;
+
 #if defined(__APPLE__)
 	virtual int setNonblock(bool nonblock);
 #endif
 
 protected:
-	CUARTController(unsigned int speed, bool assertRTS = false);
+	CUARTController(unsigned int speed, bool assertRTS = false, bool lowLatency = false);
 
 	std::string    m_device;
 	unsigned int   m_speed;
 	bool           m_assertRTS;
+	bool           m_lowLatency;
+	unsigned long long m_readTime;
 #if defined(_WIN32) || defined(_WIN64)
 	HANDLE         m_handle;
 #else
 	int            m_fd;
+	std::vector<unsigned char> m_output;
+	unsigned int   m_outputPtr;
 #endif
 
 #if defined(_WIN32) || defined(_WIN64)
 	int readNonblock(unsigned char* buffer, unsigned int length);
 #else
-	bool canWrite();
 	bool setRaw();
+	bool setLineSpeed(termios& termios);
+	bool writeOut(const unsigned char* buffer, unsigned int length, unsigned int& sent);
 #endif
 };
 
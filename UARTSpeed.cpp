@@ -0,0 +1,61 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include "UARTSpeed.h"
+
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+#endif
+
+#if defined(__linux__) && defined(TCSETS2) && defined(BOTHER)
+
+unsigned int UARTSetSpeed(int fd, unsigned int speed)
+{
+	struct termios2 termios;
+	if (::ioctl(fd, TCGETS2, &termios) < 0)
+		return 0U;
+
+	termios.c_cflag &= ~CBAUD;
+	termios.c_cflag |= BOTHER;
+	termios.c_ospeed = speed;
+#if defined(IBSHIFT)
+	termios.c_cflag &= ~(CBAUD << IBSHIFT);
+	termios.c_cflag |= BOTHER << IBSHIFT;
+#endif
+	termios.c_ispeed = speed;
+
+	if (::ioctl(fd, TCSETS2, &termios) < 0)
+		return 0U;
+
+	// The driver rounds to what its clock divider can make
+	if (::ioctl(fd, TCGETS2, &termios) < 0)
+		return 0U;
+
+	return termios.c_ospeed;
+}
+
+#else
+
+unsigned int UARTSetSpeed(int, unsigned int)
+{
+	return 0U;
+}
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#if !defined(UARTSPEED_H)
+#define	UARTSPEED_H
+
+// Sets any line speed on a Linux tty through termios2 and BOTHER, kept
+// apart from UARTController.cpp as <asm/termbits.h> clashes with
+// <termios.h>. Returns the speed the driver settled on, or 0 if the
+// driver or platform cannot do this.
+extern unsigned int UARTSetSpeed(int fd, unsigned int speed);
+
+#endif
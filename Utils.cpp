@@ -1,5 +1,5 @@
 /*
- *	Copyright (C) 2009,2014,2015,2016,2023,2025 Jonathan Naylor, G4KLX
+ *	Copyright (C) 2009,2014,2015,2016,2023,2025,2026 Jonathan Naylor, G4KLX
  *
  *	This program is free software; you can redistribute it and/or modify
  *	it under the terms of the GNU General Public License as published by
@@ -90,9 +90,11 @@ std::string CUtils::createTimestamp()
 	struct timeval now;
 	::gettimeofday(&now, nullptr);
 
-	struct tm* tm = ::gmtime(&now.tv_sec);
+	// Called from more than one thread, so the shared result of gmtime() cannot be used
+	struct tm tm;
+	::gmtime_r(&now.tv_sec, &tm);
 
-	::sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%03lldZ", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, now.tv_usec / 1000LL);
+	::sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d.%03lldZ", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, now.tv_usec / 1000LL);
 #endif
 
 	return buffer;